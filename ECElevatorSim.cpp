@@ -7,6 +7,12 @@
 
 
 #include "ECElevatorSim.h"
+#include "ElevatorRequestPool.h"
+#include "ElevatorHallCalls.h"
+#include "ECMpscRing.h"
+#include <cstdlib>
+#include <algorithm>
+#include <functional>
 
 using namespace std;
 
@@ -45,6 +51,14 @@ bool UpStrategy::containsMoreRequests(int currFloor, const std::vector<ECElevato
     return false;
 }
 
+bool UpStrategy::stopAtFloor(int floor, const ElevatorFloorDemand& demand) const {
+    return demand.HasAt(floor);
+}
+
+bool UpStrategy::containsMoreRequests(int currFloor, const ElevatorFloorDemand& demand) const {
+    return demand.HasAbove(currFloor);
+}
+
 // Get the direction of the elevator (up)
 EC_ELEVATOR_DIR UpStrategy::getDirection() const {
     return EC_ELEVATOR_UP;
@@ -84,48 +98,449 @@ bool DownStrategy::containsMoreRequests(int currFloor, const std::vector<ECEleva
     return false;
 }
 
+bool DownStrategy::stopAtFloor(int floor, const ElevatorFloorDemand& demand) const {
+    return demand.HasAt(floor);
+}
+
+bool DownStrategy::containsMoreRequests(int currFloor, const ElevatorFloorDemand& demand) const {
+    return demand.HasBelow(currFloor);
+}
+
 // Get the direction of the elevator (down)
 EC_ELEVATOR_DIR DownStrategy::getDirection() const {
     return EC_ELEVATOR_DOWN;
 }
 
+// DefaultDispatchStrategy Implementation
+// Continue in the current direction while there are requests ahead,
+// otherwise head towards the earliest request still waiting for service
+EC_ELEVATOR_DIR DefaultDispatchStrategy::chooseDirection(const ECElevatorSim& sim, int currTime) const {
+    int currFloor = sim.GetCurrFloor();
+    EC_ELEVATOR_DIR currDir = sim.GetCurrDir();
+
+    if (currDir == EC_ELEVATOR_UP && sim.HasRequestsAbove(currFloor, currTime)) {
+        return EC_ELEVATOR_UP;
+    }
+    if (currDir == EC_ELEVATOR_DOWN && sim.HasRequestsBelow(currFloor, currTime)) {
+        return EC_ELEVATOR_DOWN;
+    }
+
+    // Set the direction based on the target floor (if there is one)
+    int targetFloor = sim.GetEarliestRequestFloor(currTime);
+    if (targetFloor == -1 || targetFloor == currFloor) {
+        return EC_ELEVATOR_STOPPED;
+    }
+    return (targetFloor > currFloor) ? EC_ELEVATOR_UP : EC_ELEVATOR_DOWN;
+}
+
 // ECElevatorSim Implementation
+// Heap order of the pending requests: the one made first (ties: lower handle) on top
+static bool IsMadeLater(const ElevatorSubmittedRequest& a, const ElevatorSubmittedRequest& b) {
+    return a.time != b.time ? a.time > b.time : a.handle > b.handle;
+}
+
+static bool IsMaintenanceRequest(const ElevatorSubmittedRequest& req) {
+    return (req.floorSrc == -1 && req.floorDest == -1) || (req.floorSrc == 0 && req.floorDest == 0);
+}
+
 // Constructor
-ECElevatorSim::ECElevatorSim(int numFloorsIn, std::vector<ECElevatorSimRequest>& listRequests)
-    : numFloors(numFloorsIn), currFloor(1), currDir(EC_ELEVATOR_STOPPED), requests(listRequests) {
+ECElevatorSim::ECElevatorSim(int numFloorsIn, std::vector<ECElevatorSimRequest> listRequests, ElevatorDispatchStrategy* dispatch)
+    : numFloors(numFloorsIn), currFloor(1), currDir(EC_ELEVATOR_STOPPED),
+      pool(new ElevatorRequestPool()), waitSummary(new ElevatorWaitSummary()), numPassengerRequests(0), numWithdrawn(0),
+      demand(numFloorsIn), hallCalls(new ElevatorHallCalls(numFloorsIn)), arrivalsTime(INT_MIN),
+      lastMoveDir(EC_ELEVATOR_STOPPED), lastRunDir(EC_ELEVATOR_STOPPED), logSubscriber(NULL), currEvent(), inMaintenance(false),
+      submitted(new ECMpscRing<ElevatorSubmittedRequest>(SUBMIT_QUEUE_SIZE)),
+      firstSubmitHandle((ElevatorRequestHandle)listRequests.size()), retainResults(false) {
+    pending.reserve(listRequests.size());
+    for (size_t i = 0; i < listRequests.size(); ++i) {
+        const ECElevatorSimRequest& req = listRequests[i];
+        ElevatorSubmittedRequest entry;
+        entry.time = req.GetTime();
+        entry.floorSrc = req.GetFloorSrc();
+        entry.floorDest = req.GetFloorDest();
+        entry.handle = (ElevatorRequestHandle)i;
+        pending.push_back(entry);
+        if (!IsMaintenanceRequest(entry)) {
+            numPassengerRequests++;
+        }
+    }
+    std::make_heap(pending.begin(), pending.end(), IsMadeLater);
+
     upStrategy = new UpStrategy();
     downStrategy = new DownStrategy();
+    dispatchStrategy = (dispatch != NULL) ? dispatch : new DefaultDispatchStrategy();
+    parkingStrategy = NULL;
+    parking = false;
 }
 
 // Destructor
 ECElevatorSim::~ECElevatorSim() {
     delete upStrategy;
     delete downStrategy;
+    delete dispatchStrategy;
+    delete parkingStrategy;
+    delete pool;
+    delete hallCalls;
+    delete waitSummary;
+    delete submitted;
+    delete logSubscriber;
+}
+
+void ECElevatorSim::SetParkingStrategy(ElevatorParkingStrategy* parkingIn) {
+    delete parkingStrategy;
+    parkingStrategy = parkingIn;
+}
+
+const std::vector<ECElevatorSimRequest>& ECElevatorSim::GetRequests() const {
+    return pool->GetLive();
+}
+
+size_t ECElevatorSim::GetPeakActiveRequests() const {
+    return pool->GetPeakLive();
 }
 
 // Simulate the elevator
+// While in maintenance the car stays where it is: hall calls and riders are held
+// until the maintenance end request, then service resumes from the current floor
 void ECElevatorSim::Simulate(int lenSim) {
-    if (handlePassengers(lenSim)) {
+    EC_PROFILE_SCOPE(EC_PHASE_SIMULATE);
+    takeSubmitted();
+    handleArrivals(lenSim);
+
+    if (inMaintenance) {
+        motionStats.maintenanceTicks++;
+        //taken out of service while moving: the car stops here
+        if (lastMoveDir != EC_ELEVATOR_STOPPED) {
+            motionStats.stops++;
+        }
+        lastMoveDir = EC_ELEVATOR_STOPPED;
         return;
     }
 
-    updateElevator(lenSim);
+    int prevFloor = currFloor;
+    if (!handlePassengers(lenSim)) {
+        updateElevator(lenSim);
+    }
+    updateMotionStats(prevFloor, lenSim);
+
+    // compact between steps only, never while a loop is walking the live set
+    if (pool->NeedsCompaction()) {
+        retireServiced();
+    }
+}
+
+// logEvent helper method, announces one event to the observers subscribed to its type
+void ECElevatorSim::logEvent(EC_SIM_EVENT_TYPE type, int time, int floor, int aux, uint32_t request) {
+    if (!HasSubscribers(type)) return;
+
+    currEvent = { time, request,
+        (int16_t)floor, (int16_t)aux, (uint8_t)type, 0, 0 };
+    Notify(type);
+}
+
+void ECElevatorSim::SetEventLog(ElevatorEventLog* log) {
+    if (logSubscriber != NULL) {
+        Detach(logSubscriber);
+        delete logSubscriber;
+        logSubscriber = NULL;
+    }
+    if (log != NULL) {
+        logSubscriber = new ElevatorEventLogSubscriber(*this, *log);
+        Attach(logSubscriber, EC_ALL_EVENTS);
+    }
+}
+
+// Submit: producers only touch the ring; the handle follows from the ring position
+bool ECElevatorSim::Submit(const ECElevatorSimRequest& req, ElevatorRequestHandle* handle) {
+    ElevatorSubmittedRequest entry;
+    entry.time = req.GetTime();
+    entry.floorSrc = req.GetFloorSrc();
+    entry.floorDest = req.GetFloorDest();
+
+    uint64_t pos;
+    if (!submitted->TryPush(entry, &pos)) {
+        return false;
+    }
+    if (handle) *handle = firstSubmitHandle + (ElevatorRequestHandle)pos;
+    return true;
+}
+
+// AddRequest: the caller is the consumer, so a full ring can be emptied right here
+void ECElevatorSim::AddRequest(const ECElevatorSimRequest& req, ElevatorRequestHandle* handle) {
+    while (!Submit(req, handle)) {
+        takeSubmitted();
+    }
+}
+
+// Withdraw: the passenger leaves the demand and the hall call; the record is marked
+// done like a serviced one, but without an arrive time, and retired with them
+bool ECElevatorSim::Withdraw(ElevatorRequestHandle handle, int time) {
+    ECElevatorSimRequest* req = pool->Find(handle);
+    if (req == NULL || req->IsFloorRequestDone()) {
+        return false;
+    }
+    demand.Withdraw(req->GetFloorSrc(), req->GetFloorDest());
+    hallCalls->Withdraw(handle, req->GetFloorSrc(), req->GetFloorDest());
+    req->SetFloorRequestDone(true);
+    req->SetServiced(true);
+    liveStats.numWaiting--;
+    numWithdrawn++;
+    pool->Retire();
+    dropFinishedEarliest();
+    logEvent(EC_SIM_EV_WITHDRAWN, time, req->GetFloorSrc(), req->GetFloorDest(), handle);
+    return true;
+}
+
+// takeSubmitted helper method, moves everything queued by Submit to the pending requests
+void ECElevatorSim::takeSubmitted() {
+    ElevatorSubmittedRequest entry;
+    uint64_t pos;
+    while (submitted->TryPop(entry, &pos)) {
+        entry.handle = firstSubmitHandle + (ElevatorRequestHandle)pos;
+        pending.push_back(entry);
+        std::push_heap(pending.begin(), pending.end(), IsMadeLater);
+        if (!IsMaintenanceRequest(entry)) {
+            numPassengerRequests++;
+        }
+    }
+}
+
+// handleArrivals helper method, takes in the requests made up to this step (in time order)
+void ECElevatorSim::handleArrivals(int time) {
+    arrivalsTime = std::max(arrivalsTime, time);
+    while (!pending.empty() && pending.front().time <= time) {
+        std::pop_heap(pending.begin(), pending.end(), IsMadeLater);
+        ElevatorSubmittedRequest entry = pending.back();
+        pending.pop_back();
+
+        if (IsMaintenanceRequest(entry)) {
+            handleMaintenance(entry, time);
+        }
+        else {
+            pool->Admit(entry.handle, ECElevatorSimRequest(entry.time, entry.floorSrc, entry.floorDest));
+            demand.AddWaiting(entry.floorSrc, entry.floorDest);
+            earliest.push_back(std::make_pair(entry.time, entry.handle));
+            std::push_heap(earliest.begin(), earliest.end(), std::greater<std::pair<int, ElevatorRequestHandle>>());
+            hallCalls->AddWaiting(entry.handle, entry.floorSrc, entry.floorDest);
+            liveStats.numWaiting++;
+            if (parkingStrategy) {
+                parkingStrategy->observeArrival(entry.floorSrc, entry.time);
+            }
+            logEvent(EC_SIM_EV_REQUEST_ARRIVED, entry.time, entry.floorSrc, entry.floorDest, entry.handle);
+        }
+    }
+}
+
+// handleMaintenance helper method, carries out a maintenance start/end request
+// (these never enter the pool, so they are never taken for a passenger)
+void ECElevatorSim::handleMaintenance(const ElevatorSubmittedRequest& req, int time) {
+    ElevatorRequestResult result;
+    result.handle = req.handle;
+    result.state = EC_REQUEST_SERVICED;
+    result.time = req.time;
+    result.floorSrc = req.floorSrc;
+    result.floorDest = req.floorDest;
+    result.arriveTime = time;
+    keepResult(result);
+
+    if (req.floorSrc == -1 && !inMaintenance) {
+        inMaintenance = true;
+        motionStats.maintenancePeriods++;
+        logEvent(EC_SIM_EV_MAINTENANCE_START, time, currFloor, 0, req.handle);
+        if (currDir != EC_ELEVATOR_STOPPED) {
+            logEvent(EC_SIM_EV_DIRECTION_CHANGED, time, currFloor, EC_ELEVATOR_STOPPED);
+            currDir = EC_ELEVATOR_STOPPED;
+        }
+        parking = false;
+    }
+    else if (req.floorSrc == 0 && inMaintenance) {
+        inMaintenance = false;
+        logEvent(EC_SIM_EV_MAINTENANCE_END, time, currFloor, 0, req.handle);
+    }
+}
+
+// boardPassenger/alightPassenger helper methods, move a passenger through the stages of a request
+void ECElevatorSim::boardPassenger(ECElevatorSimRequest& req, int time) {
+    ElevatorRequestHandle handle = pool->GetHandle(req);
+    req.SetFloorRequestDone(true);
+    demand.Board(req.GetFloorSrc(), req.GetFloorDest(), req.GetTime(), time);
+    hallCalls->Board(handle, req.GetFloorSrc(), req.GetFloorDest());
+    liveStats.numWaiting--;
+    liveStats.numRiding++;
+    logEvent(EC_SIM_EV_BOARDED, time, currFloor, req.GetFloorDest(), handle);
+}
+
+void ECElevatorSim::alightPassenger(ECElevatorSimRequest& req, int time) {
+    ElevatorRequestHandle handle = pool->GetHandle(req);
+    req.SetArriveTime(time);
+    req.SetServiced(true);
+    demand.Alight(req.GetFloorSrc(), req.GetFloorDest(), req.GetTime(), time);
+    hallCalls->Alight(handle, req.GetFloorDest());
+    liveStats.numRiding--;
+    liveStats.AddCompletion(time - req.GetTime());
+    waitSummary->Add(time - req.GetTime());
+    pool->Retire();
+    dropFinishedEarliest();
+    logEvent(EC_SIM_EV_ALIGHTED, time, currFloor, req.GetFloorSrc(), handle);
+}
+
+// boardGroup helper method, the hall call of the current floor in one direction boards
+// in one pass (passengers the policy turns away stay in the group)
+void ECElevatorSim::boardGroup(bool up, int time) {
+    hallCalls->TakeWaiting(currFloor, up, groupScratch);
+    size_t numStaying = 0;
+    for (ElevatorRequestHandle handle : groupScratch) {
+        ECElevatorSimRequest& req = *pool->Find(handle);
+        if (dispatchStrategy->acceptsPickup(req, currDir)) {
+            boardPassenger(req, time);
+        }
+        else {
+            groupScratch[numStaying++] = handle;
+        }
+    }
+    groupScratch.resize(numStaying);
+    hallCalls->PutBackWaiting(currFloor, up, groupScratch);
+}
+
+// alightRiders helper method, everyone riding to the current floor gets off (in handle order)
+void ECElevatorSim::alightRiders(int time) {
+    hallCalls->TakeRiders(currFloor, groupScratch);
+    for (ElevatorRequestHandle handle : groupScratch) {
+        alightPassenger(*pool->Find(handle), time);
+    }
+}
+
+// hasNewCallHere helper method, someone started waiting at the current floor at this time
+bool ECElevatorSim::hasNewCallHere(int time) {
+    if (usesDemand(time)) {
+        for (int up = 0; up < 2; ++up) {
+            for (ElevatorRequestHandle handle : hallCalls->GetWaiting(currFloor, up == 1)) {
+                if (pool->Find(handle)->GetTime() == time) return true;
+            }
+        }
+        return false;
+    }
+
+    for (const auto& req : pool->GetLive()) {
+        if (!req.IsFloorRequestDone() && req.GetFloorSrc() == currFloor && req.GetTime() == time) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// dropFinishedEarliest helper method, pops serviced/withdrawn requests off the top of the
+// earliest heap, so its top is always the earliest request still in progress
+void ECElevatorSim::dropFinishedEarliest() {
+    while (!earliest.empty()) {
+        const ECElevatorSimRequest* req = pool->Find(earliest.front().second);
+        if (req != NULL && !req->IsServiced()) break;
+        std::pop_heap(earliest.begin(), earliest.end(), std::greater<std::pair<int, ElevatorRequestHandle>>());
+        earliest.pop_back();
+    }
+}
+
+// retireServiced helper method, drops serviced requests from the live set
+void ECElevatorSim::retireServiced() {
+    pool->Compact([this](ElevatorRequestHandle handle, const ECElevatorSimRequest& req) {
+        ElevatorRequestResult result;
+        result.handle = handle;
+        result.state = req.GetArriveTime() < 0 ? EC_REQUEST_WITHDRAWN : EC_REQUEST_SERVICED;
+        result.time = req.GetTime();
+        result.floorSrc = req.GetFloorSrc();
+        result.floorDest = req.GetFloorDest();
+        result.arriveTime = req.GetArriveTime();
+        keepResult(result);
+    });
+}
+
+void ECElevatorSim::keepResult(const ElevatorRequestResult& result) {
+    if (!retainResults) return;
+
+    if (result.handle >= finished.size()) {
+        finished.resize(result.handle + 1);
+    }
+    finished[result.handle] = result;
+}
+
+// GetResult: active requests are looked up in the pool, then retained and pending ones
+bool ECElevatorSim::GetResult(ElevatorRequestHandle handle, ElevatorRequestResult& result) const {
+    const ECElevatorSimRequest* req = pool->Find(handle);
+    if (req != NULL) {
+        result.handle = handle;
+        result.state = req->IsServiced() ? (req->GetArriveTime() < 0 ? EC_REQUEST_WITHDRAWN : EC_REQUEST_SERVICED) :
+            (req->IsFloorRequestDone() ? EC_REQUEST_RIDING : EC_REQUEST_WAITING);
+        result.time = req->GetTime();
+        result.floorSrc = req->GetFloorSrc();
+        result.floorDest = req->GetFloorDest();
+        result.arriveTime = req->GetArriveTime();
+        return true;
+    }
+    if (handle < finished.size() && finished[handle].state != EC_REQUEST_UNKNOWN) {
+        result = finished[handle];
+        return true;
+    }
+    for (const auto& entry : pending) {
+        if (entry.handle == handle) {
+            result = ElevatorRequestResult();
+            result.handle = handle;
+            result.state = EC_REQUEST_PENDING;
+            result.time = entry.time;
+            result.floorSrc = entry.floorSrc;
+            result.floorDest = entry.floorDest;
+            return true;
+        }
+    }
+    return false;
+}
+
+// updateMotionStats helper method, accounts for what the car did during this step
+void ECElevatorSim::updateMotionStats(int prevFloor, int time) {
+    EC_ELEVATOR_DIR moveDir = EC_ELEVATOR_STOPPED;
+    if (currFloor > prevFloor) {
+        moveDir = EC_ELEVATOR_UP;
+        motionStats.floorsUp += currFloor - prevFloor;
+    }
+    else if (currFloor < prevFloor) {
+        moveDir = EC_ELEVATOR_DOWN;
+        motionStats.floorsDown += prevFloor - currFloor;
+    }
+
+    if (moveDir != EC_ELEVATOR_STOPPED) {
+        motionStats.movingTicks++;
+        if (parking) {
+            motionStats.parkingTicks++;
+        }
+        if (lastMoveDir == EC_ELEVATOR_STOPPED) {
+            motionStats.starts++;
+        }
+        if (lastRunDir != EC_ELEVATOR_STOPPED && moveDir != lastRunDir) {
+            motionStats.reversals++;
+        }
+        lastRunDir = moveDir;
+    }
+    else {
+        if (lastMoveDir != EC_ELEVATOR_STOPPED) {
+            motionStats.stops++;
+        }
+        if (hasRequests(time)) {
+            motionStats.dwellTicks++;
+        }
+        else {
+            motionStats.idleTicks++;
+        }
+    }
+    lastMoveDir = moveDir;
 }
 
 // HELPER METHODS FOR ECElevatorSim:Simulate
 // handlePassengers helper method, handles the passengers
 bool ECElevatorSim::handlePassengers(int time) {
+    EC_PROFILE_SCOPE(EC_PHASE_HANDLE_PASSENGERS);
     // Check if there's a passenger already loaded and a new request at the same floor
-    for (const auto& req : requests) {
-        if (!req.IsFloorRequestDone() && req.GetFloorSrc() == currFloor && req.GetTime() == time) {
-            // Check if we already picked up someone at this floor
-            for (const auto& otherReq : requests) {
-                if (otherReq.IsFloorRequestDone() && !otherReq.IsServiced() &&
-                    otherReq.GetFloorSrc() == currFloor && otherReq.GetTime() < time) {
-                    return false;  // Don't allow new pickup, elevator should be moving
-                }
-            }
-        }
+    // (the new request has to wait: don't allow new pickup, elevator should be moving)
+    if (hasNewCallHere(time) && hasExistingPickup(currFloor, time)) {
+        return false;
     }
 
     // Normal passenger handling
@@ -139,13 +554,26 @@ bool ECElevatorSim::handlePassengers(int time) {
 
 // countPassengersAtFloor helper method, counts the number of passengers at the current floor
 int ECElevatorSim::countPassengersAtFloor(int time) {
+    if (usesDemand(time)) {
+        if (!demand.HasAt(currFloor)) return 0;
+
+        //riders for this floor plus the hall calls the policy takes
+        int count = (int)hallCalls->GetRiders(currFloor).size();
+        for (int up = 0; up < 2; ++up) {
+            for (ElevatorRequestHandle handle : hallCalls->GetWaiting(currFloor, up == 1)) {
+                if (dispatchStrategy->acceptsPickup(*pool->Find(handle), currDir)) count++;
+            }
+        }
+        return count;
+    }
+
     int count = 0;
-    for (const auto& req : requests) {
+    for (const auto& req : pool->GetLive()) {
         if (req.GetTime() > time) continue;
 
         // Check if there are passengers to unload or load at the current floor
         if ((req.IsFloorRequestDone() && !req.IsServiced() && currFloor == req.GetFloorDest()) ||
-            (!req.IsFloorRequestDone() && currFloor == req.GetFloorSrc())) {
+            (!req.IsFloorRequestDone() && currFloor == req.GetFloorSrc() && dispatchStrategy->acceptsPickup(req, currDir))) {
             count++; // Increment the count
         }
     }
@@ -154,81 +582,119 @@ int ECElevatorSim::countPassengersAtFloor(int time) {
 
 // handleAllPassengersAtFloor helper method, handles all passengers at the current floor
 void ECElevatorSim::handleAllPassengersAtFloor(int time) {
+    //only the groups of this floor are touched
+    if (usesDemand(time)) {
+        alightRiders(time);
+        boardGroup(true, time);
+        boardGroup(false, time);
+        return;
+    }
+
     //Go through the requests to see who needs to be serviced
-    for (auto& req : requests) {
+    for (auto& req : pool->GetLive()) {
         if (req.GetTime() > time) continue;
 
         //Servicing the passenger
         if (req.IsFloorRequestDone() && !req.IsServiced() && currFloor == req.GetFloorDest()) {
-            req.SetArriveTime(time);
-            req.SetServiced(true);
+            alightPassenger(req, time);
         }
 
         //Finish the floor request
-        if (!req.IsFloorRequestDone() && currFloor == req.GetFloorSrc()) {
-            req.SetFloorRequestDone(true);
+        if (!req.IsFloorRequestDone() && currFloor == req.GetFloorSrc() && dispatchStrategy->acceptsPickup(req, currDir)) {
+            boardPassenger(req, time);
         }
     }
 }
 
 //determineDirection helper method, determines the direction of the elevator
 void ECElevatorSim::determineDirection(int currTime) {
-    if (shouldContinueCurrentDirection(currTime)) {
-        return;
+    EC_PROFILE_SCOPE(EC_PHASE_DETERMINE_DIRECTION);
+    EC_ELEVATOR_DIR newDir = dispatchStrategy->chooseDirection(*this, currTime);
+
+    //nothing to do: the parking policy may send the car where the next call is likely
+    parking = false;
+    if (newDir == EC_ELEVATOR_STOPPED && parkingStrategy != NULL && !hasRequests(currTime)) {
+        int parkFloor = parkingStrategy->chooseParkingFloor(*this, currTime);
+        if (parkFloor >= 1 && parkFloor <= numFloors && parkFloor != currFloor) {
+            newDir = (parkFloor > currFloor) ? EC_ELEVATOR_UP : EC_ELEVATOR_DOWN;
+            parking = true;
+        }
     }
-
-    setNewDirection(currTime);
+    if (newDir != currDir) {
+        logEvent(EC_SIM_EV_DIRECTION_CHANGED, currTime, currFloor, newDir);
+    }
+    currDir = newDir;
 }
 
-// HELPER METHODS FOR determineDirection:
-//shouldContinueCurrentDirection helper method, checks if the elevator should continue in the current direction
-bool ECElevatorSim::shouldContinueCurrentDirection(int currTime) {
-    if (currDir == EC_ELEVATOR_STOPPED) {
-        return false;
+// Queries for dispatch policies:
+// GetEarliestRequestFloor, the floor of the earliest request that still needs service
+int ECElevatorSim::GetEarliestRequestFloor(int currTime) const {
+    //ties go to the lowest handle, the first in list order
+    if (usesDemand(currTime)) {
+        return earliest.empty() ? -1 : pool->Find(earliest.front().second)->GetRequestedFloor();
     }
 
-    ElevatorStrategy* strategy = (currDir == EC_ELEVATOR_UP) ? upStrategy : downStrategy;
-    return strategy->containsMoreRequests(currFloor, requests, currTime);
-}
-
-// Helper method for determineDirection:
-// setNewDirection helper method, sets the new direction of the elevator
-void ECElevatorSim::setNewDirection(int currTime) {
     int earliestTime = INT_MAX;
     int targetFloor = -1;
 
-    // Find the earliest request that still needs service
-    for (const auto& req : requests) {
+    for (const auto& req : pool->GetLive()) {
         // Check if the request is not serviced and the time has passed
         if (!req.IsServiced() && req.GetTime() <= currTime) {
             // Check if the request is the earliest
             if (req.GetTime() < earliestTime) {
                 earliestTime = req.GetTime();
-                targetFloor = !req.IsFloorRequestDone() ? req.GetFloorSrc() : req.GetFloorDest();
+                targetFloor = req.GetRequestedFloor();
             }
         }
     }
+    return targetFloor;
+}
 
-    // Set the direction based on the target floor (if there is one)
-    if (targetFloor != -1) {
-        if (targetFloor > currFloor) {
-            currDir = EC_ELEVATOR_UP;
-        }
-        else if (targetFloor < currFloor) {
-            currDir = EC_ELEVATOR_DOWN;
-        }
-        else {
-            currDir = EC_ELEVATOR_STOPPED;
+// GetNearestRequestFloor, the requested floor closest to the car (ties go to the lower floor)
+int ECElevatorSim::GetNearestRequestFloor(int currTime) const {
+    if (usesDemand(currTime)) {
+        return demand.GetNearest(currFloor);
+    }
+
+    int targetFloor = -1;
+    int bestDist = INT_MAX;
+
+    for (const auto& req : pool->GetLive()) {
+        if (req.IsServiced() || req.GetTime() > currTime) continue;
+
+        int floor = req.GetRequestedFloor();
+        int dist = abs(floor - currFloor);
+        if (dist < bestDist || (dist == bestDist && floor < targetFloor)) {
+            bestDist = dist;
+            targetFloor = floor;
         }
     }
-    else {
-        currDir = EC_ELEVATOR_STOPPED;
+    return targetFloor;
+}
+
+// HasRequestsAbove/Below: bit scans on the demand, or a scan of the requests
+// when the question is about an earlier time or a floor can't be represented
+bool ECElevatorSim::HasRequestsAbove(int floor, int currTime) const {
+    if (usesDemand(currTime)) {
+        return upStrategy->containsMoreRequests(floor, demand);
+    }
+    return upStrategy->containsMoreRequests(floor, pool->GetLive(), currTime);
+}
+
+bool ECElevatorSim::HasRequestsBelow(int floor, int currTime) const {
+    if (usesDemand(currTime)) {
+        return downStrategy->containsMoreRequests(floor, demand);
     }
+    return downStrategy->containsMoreRequests(floor, pool->GetLive(), currTime);
 }
 
 // hasRequests helper method, checks if there are requests
 bool ECElevatorSim::hasRequests(int currTime) const {
-    for (const auto& req : requests) {
+    if (usesDemand(currTime)) {
+        return demand.HasAny();
+    }
+
+    for (const auto& req : pool->GetLive()) {
         if (!req.IsServiced() && req.GetTime() <= currTime) {
             return true;
         }
@@ -239,24 +705,31 @@ bool ECElevatorSim::hasRequests(int currTime) const {
 // Update the elevator
 void ECElevatorSim::updateElevator(int time) {
     handleStop(time);
-    moveElevator();
+    moveElevator(time);
     determineDirection(time);
 }
 
 // HELPER METHODS FOR updateElevator:
 // moveElavator helper method, moves the elevator
-void ECElevatorSim::moveElevator() {
+void ECElevatorSim::moveElevator(int currTime) {
+    EC_PROFILE_SCOPE(EC_PHASE_MOVE_ELEVATOR);
+    int prevFloor = currFloor;
     if (currDir == EC_ELEVATOR_UP && currFloor < numFloors) {
         currFloor++;
     }
     else if (currDir == EC_ELEVATOR_DOWN && currFloor > 1) {
         currFloor--;
     }
+
+    if (currFloor != prevFloor) {
+        logEvent(EC_SIM_EV_CAR_MOVED, currTime, currFloor, prevFloor);
+    }
 }
 
 // Helper method for updateElevator:
 // handleStop helper method, handles the elevator stop
 void ECElevatorSim::handleStop(int currTime) {
+    EC_PROFILE_SCOPE(EC_PHASE_HANDLE_STOP);
     bool handledPassenger = false;
     handleUnloading(currTime, handledPassenger);
     handleLoading(currTime, handledPassenger);
@@ -266,7 +739,11 @@ void ECElevatorSim::handleStop(int currTime) {
 //Helper methods for handleStop:
 //hasExistingPickup helper method, checks if there is an existing pickup
 bool ECElevatorSim::hasExistingPickup(int floor, int currTime) {
-    for (const auto& req : requests) {
+    if (usesDemand(currTime)) {
+        return demand.HasEarlierRiderFrom(floor, currTime);
+    }
+
+    for (const auto& req : pool->GetLive()) {
         if (req.IsFloorRequestDone() && !req.IsServiced() &&
             req.GetFloorSrc() == floor && req.GetTime() < currTime) {
             return true;
@@ -278,10 +755,16 @@ bool ECElevatorSim::hasExistingPickup(int floor, int currTime) {
 //Helper methods for handleStop:
 //handleUnloading helper method, unloads the passenger
 void ECElevatorSim::handleUnloading(int currTime, bool& handledPassenger) {
-    for (auto& req : requests) {
+    if (usesDemand(currTime)) {
+        if (!demand.HasDropoffAt(currFloor)) return;
+        alightRiders(currTime);
+        handledPassenger = true;
+        return;
+    }
+
+    for (auto& req : pool->GetLive()) {
         if (req.IsFloorRequestDone() && !req.IsServiced() && req.GetFloorDest() == currFloor) {
-            req.SetServiced(true);
-            req.SetArriveTime(currTime);
+            alightPassenger(req, currTime);
             handledPassenger = true;
         }
     }
@@ -291,12 +774,31 @@ void ECElevatorSim::handleUnloading(int currTime, bool& handledPassenger) {
 //handleLoading helper method, loads the passenger
 void ECElevatorSim::handleLoading(int currTime, bool handledPassenger) {
     if (handledPassenger) return;
+    if (usesDemand(currTime)) {
+        if (!demand.HasPickupAt(currFloor) || hasExistingPickup(currFloor, currTime)) return;
+
+        //the first passenger (in handle order) of either hall call the policy takes
+        ECElevatorSimRequest* first = NULL;
+        for (int up = 0; up < 2; ++up) {
+            for (ElevatorRequestHandle handle : hallCalls->GetWaiting(currFloor, up == 1)) {
+                ECElevatorSimRequest* req = pool->Find(handle);
+                if (!dispatchStrategy->acceptsPickup(*req, currDir)) continue;
+                if (first == NULL || handle < pool->GetHandle(*first)) first = req;
+                break;
+            }
+        }
+        if (first != NULL) {
+            boardPassenger(*first, currTime);
+        }
+        return;
+    }
 
-    for (auto& req : requests) {
+    for (auto& req : pool->GetLive()) {
         if (!req.IsFloorRequestDone() && !req.IsServiced() &&
-            req.GetFloorSrc() == currFloor && req.GetTime() <= currTime) {
+            req.GetFloorSrc() == currFloor && req.GetTime() <= currTime &&
+            dispatchStrategy->acceptsPickup(req, currDir)) {
             if (!hasExistingPickup(currFloor, currTime)) {
-                req.SetFloorRequestDone(true);
+                boardPassenger(req, currTime);
                 break;
             }
         }
@@ -15,6 +15,16 @@
 #include <map>
 #include <string>
 #include <climits>
+#include <utility>
+#include "ElevatorEventLog.h"
+#include "ECObserver.h"
+#include "ECProfiler.h"
+#include "ElevatorFloorDemand.h"
+
+class ElevatorRequestPool;
+class ElevatorWaitSummary;
+class ElevatorHallCalls;
+template <class T> class ECMpscRing;
 
 //*****************************************************************************
 // DON'T CHANGE THIS CLASS
@@ -104,6 +114,9 @@ public:
     virtual ~ElevatorStrategy() {}
     virtual bool stopAtFloor(int floor, const std::vector<ECElevatorSimRequest>& requests, int currTime) const = 0;
     virtual bool containsMoreRequests(int currFloor, const std::vector<ECElevatorSimRequest>& requests, int currTime) const = 0;
+    // Same questions answered from the floor demand bits (requests made so far)
+    virtual bool stopAtFloor(int floor, const ElevatorFloorDemand& demand) const = 0;
+    virtual bool containsMoreRequests(int currFloor, const ElevatorFloorDemand& demand) const = 0;
     virtual EC_ELEVATOR_DIR getDirection() const = 0;
 };
 
@@ -112,6 +125,8 @@ class UpStrategy : public ElevatorStrategy
 public:
     bool stopAtFloor(int floor, const std::vector<ECElevatorSimRequest>& requests, int currTime) const override;
     bool containsMoreRequests(int currFloor, const std::vector<ECElevatorSimRequest>& requests, int currTime) const override;
+    bool stopAtFloor(int floor, const ElevatorFloorDemand& demand) const override;
+    bool containsMoreRequests(int currFloor, const ElevatorFloorDemand& demand) const override;
     EC_ELEVATOR_DIR getDirection() const override;
 };
 
@@ -120,17 +135,168 @@ class DownStrategy : public ElevatorStrategy
 public:
     bool stopAtFloor(int floor, const std::vector<ECElevatorSimRequest>& requests, int currTime) const override;
     bool containsMoreRequests(int currFloor, const std::vector<ECElevatorSimRequest>& requests, int currTime) const override;
+    bool stopAtFloor(int floor, const ElevatorFloorDemand& demand) const override;
+    bool containsMoreRequests(int currFloor, const ElevatorFloorDemand& demand) const override;
     EC_ELEVATOR_DIR getDirection() const override;
 };
 
+// Motion counters of one car, updated once per simulated time step
+struct ElevatorMotionStats
+{
+    int floorsUp = 0;        // floors traveled upwards
+    int floorsDown = 0;      // floors traveled downwards
+    int starts = 0;          // car started moving after standing
+    int stops = 0;           // car came to a stand after moving
+    int reversals = 0;       // travel direction changed between two runs
+    int movingTicks = 0;     // steps spent moving
+    int dwellTicks = 0;      // steps standing with requests outstanding (loading/unloading)
+    int idleTicks = 0;       // steps standing with nothing to do
+    int parkingTicks = 0;    // steps moving to a parking floor with nothing to do
+    int maintenanceTicks = 0;    // steps out of service
+    int maintenancePeriods = 0;  // number of times the car was taken out of service
+
+    int GetFloorsTraveled() const { return floorsUp + floorsDown; }
+
+    // Totals over several cars
+    void Add(const ElevatorMotionStats& other)
+    {
+        floorsUp += other.floorsUp;
+        floorsDown += other.floorsDown;
+        starts += other.starts;
+        stops += other.stops;
+        reversals += other.reversals;
+        movingTicks += other.movingTicks;
+        dwellTicks += other.dwellTicks;
+        idleTicks += other.idleTicks;
+        parkingTicks += other.parkingTicks;
+        maintenanceTicks += other.maintenanceTicks;
+        maintenancePeriods += other.maintenancePeriods;
+    }
+};
+
+// Passenger counters kept up to date as the simulation runs (no rescans needed)
+struct ElevatorLiveStats
+{
+    static const int ROLLING_WINDOW = 20;   // completions in the rolling average
+
+    int numWaiting = 0;          // made a request, not boarded yet
+    int numRiding = 0;           // in the cabin
+    int numServiced = 0;
+    long long totalWait = 0;     // over all serviced requests
+    int lastWait = -1;           // wait of the most recently serviced request
+    int recentWaits[ROLLING_WINDOW] = {};
+    int numRecent = 0;
+    long long recentSum = 0;
+
+    void AddCompletion(int wait)
+    {
+        int slot = numServiced % ROLLING_WINDOW;
+        if (numRecent == ROLLING_WINDOW) {
+            recentSum -= recentWaits[slot];
+        }
+        else {
+            numRecent++;
+        }
+        recentWaits[slot] = wait;
+        recentSum += wait;
+
+        numServiced++;
+        totalWait += wait;
+        lastWait = wait;
+    }
+    double GetAverageWait() const { return numServiced > 0 ? (double)totalWait / numServiced : 0.0; }
+    double GetRollingAverageWait() const { return numRecent > 0 ? (double)recentSum / numRecent : 0.0; }
+};
+
+class ECElevatorSim;
+
+// Stable id of a request for the whole run: requests given to the constructor
+// are numbered in list order, submitted ones follow in the order they were queued
+typedef uint32_t ElevatorRequestHandle;
+
+// A request as it is queued/held before its time comes
+struct ElevatorSubmittedRequest
+{
+    int time = 0;
+    int floorSrc = 0;
+    int floorDest = 0;
+    ElevatorRequestHandle handle = 0;
+};
+
+typedef enum
+{
+    EC_REQUEST_UNKNOWN = 0,     // not (yet) seen by the simulator, or finished and not retained
+    EC_REQUEST_PENDING,         // request time not reached yet
+    EC_REQUEST_WAITING,         // waiting at floorSrc
+    EC_REQUEST_RIDING,          // in the cabin
+    EC_REQUEST_SERVICED,        // arrived (maintenance requests: carried out)
+    EC_REQUEST_WITHDRAWN        // the passenger gave up waiting (see ECElevatorSim::Withdraw)
+} EC_REQUEST_STATE;
+
+// Read-only outcome of one request
+struct ElevatorRequestResult
+{
+    ElevatorRequestHandle handle = 0;
+    EC_REQUEST_STATE state = EC_REQUEST_UNKNOWN;
+    int time = 0;
+    int floorSrc = 0;
+    int floorDest = 0;
+    int arriveTime = -1;
+};
+
+// Dispatch policy: decides which way the car heads next (SCAN, LOOK, ...)
+// Implementations are created by name through ElevatorStrategyRegistry
+class ElevatorDispatchStrategy
+{
+public:
+    virtual ~ElevatorDispatchStrategy() {}
+    virtual const char* getName() const = 0;
+
+    // Direction for the next step; called after every stop/move
+    virtual EC_ELEVATOR_DIR chooseDirection(const ECElevatorSim& sim, int currTime) const = 0;
+
+    // Whether a waiting passenger may board while the car heads in currDir
+    virtual bool acceptsPickup(const ECElevatorSimRequest&, EC_ELEVATOR_DIR) const { return true; }
+};
+
+// Parking policy: where an idle car (nothing requested) waits for the next call.
+// It sees every passenger request as it is made
+class ElevatorParkingStrategy
+{
+public:
+    virtual ~ElevatorParkingStrategy() {}
+    virtual const char* getName() const = 0;
+
+    // A passenger request made at time from floorSrc
+    virtual void observeArrival(int floorSrc, int time) = 0;
+
+    // Floor to move to while idle; -1 (or the current floor) stays put
+    virtual int chooseParkingFloor(const ECElevatorSim& sim, int currTime) = 0;
+};
+
 //*****************************************************************************
 // Simulation of elevator
+//
+// The simulator is also an observer subject: every state change (request
+// arrived, boarded, alighted, car moved, direction changed, maintenance) is
+// announced to the observers subscribed to its EC_SIM_EVENT_TYPE, e.g.
+//   sim.Attach(&obs, ECEventBit(EC_SIM_EV_BOARDED) | ECEventBit(EC_SIM_EV_ALIGHTED));
+// and read in Update() with GetCurrEvent(). Nothing is allocated per event, and
+// an event nobody subscribed to costs one mask test
+
+class ElevatorEventLogSubscriber;
 
-class ECElevatorSim
+class ECElevatorSim : public ECObserverSubject
 {
 public:
     // numFloors: number of floors serviced (floors numbers from 1 to numFloors)
-    ECElevatorSim(int numFloors, std::vector<ECElevatorSimRequest>& listRequests);
+    // listRequests: requests known up front (pass with std::move to hand them over without a copy);
+    // the caller's list is never touched during the simulation, results are read with GetResult
+    // dispatch: policy deciding the direction (owned by the simulator); NULL means the default policy
+    ECElevatorSim(int numFloors, std::vector<ECElevatorSimRequest> listRequests = std::vector<ECElevatorSimRequest>(),
+        ElevatorDispatchStrategy* dispatch = NULL);
+    ECElevatorSim(const ECElevatorSim&) = delete;
+    ECElevatorSim& operator=(const ECElevatorSim&) = delete;
 
     // free buffer
     ~ECElevatorSim();
@@ -141,6 +307,24 @@ public:
     // at a specific time of simulation, some events may be made in the future (which you shouldn't consider these future requests)
     void Simulate(int lenSim);
 
+    // Queue a request while the simulation runs; safe to call from any thread and never blocks.
+    // It is taken in at the start of the next Simulate step (and served from its own time on, so a
+    // request submitted late counts its full wait). Returns false if the queue is full (retry later)
+    static const size_t SUBMIT_QUEUE_SIZE = 4096;
+    bool Submit(const ECElevatorSimRequest& req, ElevatorRequestHandle* handle = NULL);
+
+    // Queue a request from the thread that runs Simulate (between steps); never fails:
+    // when the queue is full it is first taken in, so any number can be added in one step
+    void AddRequest(const ECElevatorSimRequest& req, ElevatorRequestHandle* handle = NULL);
+
+    // A waiting passenger gives up (balks, takes the stairs): the request is dropped
+    // without being serviced and counts as withdrawn. Call between steps, from the
+    // thread that runs Simulate; false if the request isn't waiting at its floor
+    bool Withdraw(ElevatorRequestHandle handle, int time);
+
+    // Passenger requests withdrawn so far
+    int GetNumWithdrawn() const { return numWithdrawn; }
+
     // The following methods are about querying/setting states of the elevator
     // which include (i) number of floors of the elevator, 
     // (ii) the current floor: which is the elevator at right now (at the time of this querying). Note: we don't model the tranisent states like when the elevator is between two floors
@@ -161,25 +345,86 @@ public:
     // Set current direction
     void SetCurrDir(EC_ELEVATOR_DIR dir) { currDir = dir; };
 
+    // Is the car out of service (between a maintenance start and end request)?
+    bool IsInMaintenance() const { return inMaintenance; }
+
     //custom GetRequests method added which is needed for part 3
-    const std::vector<ECElevatorSimRequest>& GetRequests() const { return requests; }
+    //the active requests: made by now and not retired (serviced ones are dropped every so often)
+    const std::vector<ECElevatorSimRequest>& GetRequests() const;
+
+    // Number of passenger requests taken in so far (maintenance requests not counted)
+    int GetNumPassengerRequests() const { return numPassengerRequests; }
+
+    // State and arrive time of a request; false if the handle is unknown.
+    // Finished requests are only kept if results are retained (off by default, so
+    // memory follows the active requests); turn it on to read finished ones back
+    bool GetResult(ElevatorRequestHandle handle, ElevatorRequestResult& result) const;
+    void SetRetainResults(bool retain) { retainResults = retain; }
+
+    // Wait times of all serviced requests, including retired ones
+    const ElevatorWaitSummary& GetWaitSummary() const { return *waitSummary; }
+
+    // Largest number of active requests held at once
+    size_t GetPeakActiveRequests() const;
+
+    // Dispatch policy in use
+    const ElevatorDispatchStrategy& GetDispatchStrategy() const { return *dispatchStrategy; }
+
+    // Queries used by dispatch policies (only requests made by currTime count)
+    bool HasRequestsAbove(int floor, int currTime) const;
+    bool HasRequestsBelow(int floor, int currTime) const;
+    int GetEarliestRequestFloor(int currTime) const;   // -1 if none
+    int GetNearestRequestFloor(int currTime) const;    // -1 if none
+
+    // Hall calls and drop-offs per floor, as bits
+    const ElevatorFloorDemand& GetFloorDemand() const { return demand; }
+
+    // The same as request groups: waiting per floor and direction, riders per destination
+    const ElevatorHallCalls& GetHallCalls() const { return *hallCalls; }
+
+    // Distance, stops, reversals and idle time so far
+    const ElevatorMotionStats& GetMotionStats() const { return motionStats; }
+
+    // Waiting/riding passengers and wait times so far
+    const ElevatorLiveStats& GetLiveStats() const { return liveStats; }
+
+    // Idle repositioning (owned by the simulator); NULL, the default, leaves an idle car where it is
+    void SetParkingStrategy(ElevatorParkingStrategy* parking);
+    const ElevatorParkingStrategy* GetParkingStrategy() const { return parkingStrategy; }
+
+    // The event being announced (valid during Update() of a subscribed observer)
+    const ElevatorEventRecord& GetCurrEvent() const { return currEvent; }
+
+    // Record every state transition into log (not owned; NULL turns logging off).
+    // The log is written by a subscriber like any other
+    void SetEventLog(ElevatorEventLog* log);
 
 private:
     // Your code here
     void handleStop(int currTime);
-    void moveElevator();
+    void moveElevator(int currTime);
     void determineDirection(int currTime);
     bool hasRequests(int currTime) const;
+    bool usesDemand(int currTime) const { return currTime >= arrivalsTime && demand.IsExact(); }
 
     //Simulate Helper Methods
     bool handlePassengers(int time);
     int countPassengersAtFloor(int time);
     void handleAllPassengersAtFloor(int time);
     void updateElevator(int time);
-
-    // determineDirection Helper Methods
-    bool shouldContinueCurrentDirection(int currTime);
-    void setNewDirection(int currTime);
+    void updateMotionStats(int prevFloor, int time);
+    void takeSubmitted();
+    void handleArrivals(int time);
+    void handleMaintenance(const ElevatorSubmittedRequest& req, int time);
+    void boardPassenger(ECElevatorSimRequest& req, int time);
+    void alightPassenger(ECElevatorSimRequest& req, int time);
+    void boardGroup(bool up, int time);
+    void alightRiders(int time);
+    bool hasNewCallHere(int time);
+    void dropFinishedEarliest();
+    void retireServiced();
+    void keepResult(const ElevatorRequestResult& result);
+    void logEvent(EC_SIM_EVENT_TYPE type, int time, int floor, int aux, uint32_t request = EC_SIM_EV_NO_REQUEST);
 
     //handleStop helper methods
     bool hasExistingPickup(int floor, int currTime);
@@ -189,9 +434,58 @@ private:
     int numFloors;
     int currFloor;
     EC_ELEVATOR_DIR currDir;
-    std::vector<ECElevatorSimRequest>& requests;
+    ElevatorRequestPool* pool;                     // active requests
+    ElevatorWaitSummary* waitSummary;
+    int numPassengerRequests;
+    int numWithdrawn;
+    ElevatorFloorDemand demand;    // floors of the requests in the pool
+    std::vector<std::pair<int, ElevatorRequestHandle>> earliest;   // (time, handle) of the pool's requests,
+                                                                   // min-heap; finished ones leave from the top
+    ElevatorHallCalls* hallCalls;  // the requests in the pool, grouped by floor
+    std::vector<ElevatorRequestHandle> groupScratch;   // group taken out while boarding/alighting
+    int arrivalsTime;              // time of the latest handleArrivals; the pool has nothing later
     ElevatorStrategy* upStrategy;
     ElevatorStrategy* downStrategy;
+    ElevatorDispatchStrategy* dispatchStrategy;
+    ElevatorParkingStrategy* parkingStrategy;
+    bool parking;                  // currDir was set by the parking policy
+    ElevatorMotionStats motionStats;
+    EC_ELEVATOR_DIR lastMoveDir;   // direction of the previous step (STOPPED if the car stood)
+    EC_ELEVATOR_DIR lastRunDir;    // direction of the most recent run, for counting reversals
+    ElevatorEventLogSubscriber* logSubscriber;   // writes the events to the event log
+    ElevatorEventRecord currEvent;
+    bool inMaintenance;
+    ElevatorLiveStats liveStats;
+    std::vector<ElevatorSubmittedRequest> pending;   // requests not made yet (heap, earliest on top)
+    ECMpscRing<ElevatorSubmittedRequest>* submitted;  // queued by Submit, not taken in yet
+    ElevatorRequestHandle firstSubmitHandle;         // handle of the first submitted request
+    bool retainResults;
+    std::vector<ElevatorRequestResult> finished;     // retained results, by handle
+};
+
+//*****************************************************************************
+// Appends every simulator event to an event log
+
+class ElevatorEventLogSubscriber : public ECObserver
+{
+public:
+    ElevatorEventLogSubscriber(const ECElevatorSim& sim, ElevatorEventLog& log) : sim(sim), log(log) {}
+    void Update() override { log.Append(sim.GetCurrEvent()); }
+
+private:
+    const ECElevatorSim& sim;
+    ElevatorEventLog& log;
+};
+
+//*****************************************************************************
+// Default dispatch policy: keep going while there are requests ahead,
+// otherwise head for the earliest outstanding request
+
+class DefaultDispatchStrategy : public ElevatorDispatchStrategy
+{
+public:
+    const char* getName() const override { return "default"; }
+    EC_ELEVATOR_DIR chooseDirection(const ECElevatorSim& sim, int currTime) const override;
 };
 
 
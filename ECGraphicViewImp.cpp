@@ -10,6 +10,8 @@
 #include <allegro5/allegro_image.h>
 #include <allegro5/allegro_ttf.h>
 #include <iostream>
+#include <algorithm>
+#include <mutex>
 
 
 using namespace std;
@@ -35,9 +37,17 @@ ALLEGRO_COLOR arrayAllegroColors[ECGV_NUM_COLORS] =
 // A graphic view implementation
 // This is built on top of Allegro library
 
-ECGraphicViewImp::ECGraphicViewImp(int width, int height) : widthView(width), heightView(height), fRedraw(false), display(NULL), timer(NULL), event_queue(NULL)
+ECGraphicViewImp::ECGraphicViewImp(int width, int height, bool offscreenIn) : widthView(width), heightView(height), fRedraw(false),
+    offscreen(offscreenIn), fDrawing(true), frameBuffer(NULL), display(NULL), timer(NULL), event_queue(NULL), fontDef(NULL)
 {
-    Init();
+    if (offscreen)
+    {
+        InitOffscreen();
+    }
+    else
+    {
+        Init();
+    }
 }
 ECGraphicViewImp :: ~ECGraphicViewImp()
 {
@@ -47,6 +57,11 @@ ECGraphicViewImp :: ~ECGraphicViewImp()
 // Show the view. This would enter a forever loop, until quit is set
 void ECGraphicViewImp::Show()
 {
+    if (offscreen)
+    {
+        return;   // no window, see RenderFrame
+    }
+
     //
     //int cursorxDown=-100, cursoryDown=-100, cursorxUp=-100, cursoryUp=-100;
     while (true)
@@ -65,15 +80,30 @@ void ECGraphicViewImp::Show()
             break;
         }
 
-        // render start
-        RenderStart();
+        // the cursor position is read when needed, so queued moves are one move
+        if (evtCurrent == ECGV_EV_MOUSE_MOVING)
+        {
+            CoalesceMouseMoves();
+        }
+
+        // nobody listens: nothing to draw or notify
+        if (!HasSubscribers(evtCurrent))
+        {
+            continue;
+        }
+
+        // render start (only a timer event ends in a redraw)
+        if (evtCurrent == ECGV_EV_TIMER)
+        {
+            RenderStart();
+        }
 
         // draw something
         //DrawRectangle(100,100,200,200,3);
     //SetRedraw(true);
 
         // Notify clients
-        Notify();
+        Notify(evtCurrent);
 
         // refresh view
         if (evtCurrent == ECGV_EV_TIMER)
@@ -198,15 +228,50 @@ void ECGraphicViewImp::Init()
     al_init_primitives_addon();
 
     // init font
+    InitFont();
+
+    cout << "Done with initialization.\n";
+}
+
+// Offscreen: everything is drawn into a memory bitmap, nothing needs a display.
+// Allegro's own setup isn't thread safe, so views made on several threads take turns
+void ECGraphicViewImp::InitOffscreen()
+{
+    static std::mutex initLock;
+    std::lock_guard<std::mutex> guard(initLock);
+
+    if (!al_init()) {
+        cout << "failed to initialize allegro!\n";
+        exit(-1);
+    }
+    al_init_image_addon();
+    al_init_primitives_addon();
+
+    // the new bitmap flags and the target bitmap belong to the calling thread
+    al_set_new_bitmap_flags(ALLEGRO_MEMORY_BITMAP);
+    frameBuffer = al_create_bitmap(widthView, heightView);
+    if (!frameBuffer) {
+        cout << "failed to create frame buffer!\n";
+        exit(-1);
+    }
+    al_set_target_bitmap(frameBuffer);
+    InitFont();
+}
+
+void ECGraphicViewImp::InitFont()
+{
     al_init_font_addon();
     al_init_ttf_addon();
     this->fontDef = al_load_font("C:\\Users\\crjac\\Documents\\lucon.ttf", 20, 0);
     if (this->fontDef == NULL)
     {
-        cout << "Warning: font is not loaded!\n";
+        // the built-in bitmap font is always there
+        this->fontDef = al_create_builtin_font();
+        if (this->fontDef == NULL)
+        {
+            cout << "Warning: font is not loaded!\n";
+        }
     }
-
-    cout << "Done with initialization.\n";
 }
 
 void ECGraphicViewImp::Shutdown()
@@ -227,6 +292,65 @@ void ECGraphicViewImp::Shutdown()
         al_destroy_event_queue(event_queue);
         event_queue = NULL;
     }
+    if (frameBuffer != NULL)
+    {
+        al_destroy_bitmap(frameBuffer);
+        frameBuffer = NULL;
+    }
+}
+
+// Offscreen frames: a timer event goes to the observers, which draw into the frame buffer
+bool ECGraphicViewImp::RenderFrame()
+{
+    if (!offscreen)
+    {
+        return false;
+    }
+    al_set_target_bitmap(frameBuffer);
+    evtCurrent = ECGV_EV_TIMER;
+    if (fDrawing)
+    {
+        RenderStart();
+    }
+    fRedraw = false;
+    Notify(evtCurrent);
+
+    bool drawn = fRedraw;
+    fRedraw = false;
+    return drawn;
+}
+
+bool ECGraphicViewImp::ReadFrame(std::vector<unsigned char>& rgba) const
+{
+    if (frameBuffer == NULL)
+    {
+        return false;
+    }
+    ALLEGRO_LOCKED_REGION* region = al_lock_bitmap(frameBuffer, ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_LOCK_READONLY);
+    if (region == NULL)
+    {
+        return false;
+    }
+
+    // rows may be stored bottom up (negative pitch)
+    rgba.resize((size_t)widthView * heightView * 4);
+    for (int y = 0; y < heightView; ++y)
+    {
+        const unsigned char* row = (const unsigned char*)region->data + (ptrdiff_t)y * region->pitch;
+        std::copy(row, row + widthView * 4, rgba.begin() + (size_t)y * widthView * 4);
+    }
+    al_unlock_bitmap(frameBuffer);
+    return true;
+}
+
+bool ECGraphicViewImp::SaveFrame(const std::string& path) const
+{
+    return frameBuffer != NULL && al_save_bitmap(path.c_str(), frameBuffer);
+}
+
+int ECGraphicViewImp::GetFrameRate() const
+{
+    return (int)FPS;
 }
 
 ECGVEventType ECGraphicViewImp::WaitForEvent()
@@ -244,7 +368,14 @@ ECGVEventType ECGraphicViewImp::WaitForEvent()
         return ECGV_EV_TIMER;
     }
     else if (ev.type == ALLEGRO_EVENT_KEY_DOWN) {
-        switch (ev.keyboard.keycode) {
+        int keycode = ev.keyboard.keycode;
+        if (keycode >= ALLEGRO_KEY_0 && keycode <= ALLEGRO_KEY_9) {
+            return (ECGVEventType)(ECGV_EV_KEY_DOWN_0 + (keycode - ALLEGRO_KEY_0));
+        }
+        if (keycode >= ALLEGRO_KEY_PAD_0 && keycode <= ALLEGRO_KEY_PAD_9) {
+            return (ECGVEventType)(ECGV_EV_KEY_DOWN_0 + (keycode - ALLEGRO_KEY_PAD_0));
+        }
+        switch (keycode) {
         case ALLEGRO_KEY_UP:
             return ECGV_EV_KEY_DOWN_UP;
 
@@ -272,6 +403,16 @@ ECGVEventType ECGraphicViewImp::WaitForEvent()
         case ALLEGRO_KEY_G:
             return ECGV_EV_KEY_DOWN_G;
 
+        case ALLEGRO_KEY_ESCAPE:
+            return ECGV_EV_KEY_DOWN_ESCAPE;
+
+        case ALLEGRO_KEY_ENTER:
+        case ALLEGRO_KEY_PAD_ENTER:
+            return ECGV_EV_KEY_DOWN_ENTER;
+
+        case ALLEGRO_KEY_BACKSPACE:
+            return ECGV_EV_KEY_DOWN_BACKSPACE;
+
         }
     }
     else if (ev.type == ALLEGRO_EVENT_KEY_UP) {
@@ -325,8 +466,24 @@ ECGVEventType ECGraphicViewImp::WaitForEvent()
     return ECGV_EV_NULL;
 }
 
+// Drop the mouse moves queued right behind the current one
+void ECGraphicViewImp::CoalesceMouseMoves()
+{
+    ALLEGRO_EVENT next;
+    while (al_peek_next_event(event_queue, &next) && next.type == ALLEGRO_EVENT_MOUSE_AXES)
+    {
+        al_drop_next_event(event_queue);
+    }
+}
+
 void ECGraphicViewImp::GetCursorPosition(int& cx, int& cy) const
 {
+    if (offscreen)
+    {
+        // no mouse
+        cx = cy = -1;
+        return;
+    }
     ALLEGRO_MOUSE_STATE state;
     al_get_mouse_state(&state);
     cx = state.x;
@@ -336,6 +493,7 @@ void ECGraphicViewImp::GetCursorPosition(int& cx, int& cy) const
 // Drawing functions
 void  ECGraphicViewImp::DrawLine(int x1, int y1, int x2, int y2, int thickness, ECGVColor color)
 {
+    if (!fDrawing) return;
     // draw a line
     al_draw_line(x1, y1, x2, y2, arrayAllegroColors[color], thickness);
     //cout << "Draw line: (" << x1 << "," << y1 << " to (" << x2 << "," << y2 << ")\n";
@@ -343,43 +501,58 @@ void  ECGraphicViewImp::DrawLine(int x1, int y1, int x2, int y2, int thickness,
 
 void ECGraphicViewImp::DrawRectangle(int x1, int y1, int x2, int y2, int thickness, ECGVColor color)
 {
+    if (!fDrawing) return;
     al_draw_rectangle(x1, y1, x2, y2, arrayAllegroColors[color], thickness);
 }
 
 void ECGraphicViewImp::DrawCircle(int xcenter, int ycenter, double radius, int thickness, ECGVColor color)
 {
+    if (!fDrawing) return;
     al_draw_circle(xcenter, ycenter, radius, arrayAllegroColors[color], thickness);
 }
 
 void ECGraphicViewImp::DrawEllipse(int xcenter, int ycenter, double radiusx, double radiusy, int thickness, ECGVColor color)
 {
+    if (!fDrawing) return;
     al_draw_ellipse(xcenter, ycenter, radiusx, radiusy, arrayAllegroColors[color], thickness);
 }
 
 void ECGraphicViewImp::DrawFilledRectangle(int x1, int y1, int x2, int y2, ECGVColor color)
 {
+    if (!fDrawing) return;
     al_draw_filled_rectangle(x1, y1, x2, y2, arrayAllegroColors[color]);;
 }
 
+void ECGraphicViewImp::DrawFilledRectangleRGB(int x1, int y1, int x2, int y2, unsigned char r, unsigned char g, unsigned char b)
+{
+    if (!fDrawing) return;
+    al_draw_filled_rectangle(x1, y1, x2, y2, al_map_rgb(r, g, b));
+}
+
 void ECGraphicViewImp::DrawFilledCircle(int xcenter, int ycenter, double radius, ECGVColor color)
 {
+    if (!fDrawing) return;
     al_draw_filled_circle(xcenter, ycenter, radius, arrayAllegroColors[color]);
 }
 
 void ECGraphicViewImp::DrawFilledEllipse(int xcenter, int ycenter, double radiusx, double radiusy, ECGVColor color)
 {
+    if (!fDrawing) return;
     al_draw_filled_ellipse(xcenter, ycenter, radiusx, radiusy, arrayAllegroColors[color]);
 }
 
 void ECGraphicViewImp::DrawText(int xcenter, int ycenter, const char* ptext, ECGVColor color)
 {
+    if (!fDrawing) return;
     al_draw_text(this->fontDef, arrayAllegroColors[color], xcenter, ycenter, ALLEGRO_ALIGN_CENTER, ptext);
 }
 
 void ECGraphicViewImp::DrawTriangle(int x1, int y1, int x2, int y2, int x3, int y3, int thickness, ECGVColor color) {
+    if (!fDrawing) return;
     al_draw_triangle(x1, y1, x2, y2, x3, y3, arrayAllegroColors[color], thickness);
 }
 
 void ECGraphicViewImp::DrawFilledTriangle(int x1, int y1, int x2, int y2, int x3, int y3, ECGVColor color) {
+    if (!fDrawing) return;
     al_draw_filled_triangle(x1, y1, x2, y2, x3, y3, arrayAllegroColors[color]);
 }
\ No newline at end of file
@@ -18,6 +18,7 @@
 #define ECGraphicViewImp_h
 
 #include <vector>
+#include <string>
 #include <map>
 #include "ECObserver.h"
 #include <allegro5/allegro.h>
@@ -54,9 +55,36 @@ enum ECGVEventType
     ECGV_EV_KEY_UP_SPACE = 21,
     ECGV_EV_KEY_DOWN_SPACE = 22,
     ECGV_EV_KEY_DOWN_G = 23,
-    ECGV_EV_KEY_UP_G = 24
+    ECGV_EV_KEY_UP_G = 24,
+    ECGV_EV_KEY_DOWN_0 = 25,    // digits: ECGV_EV_KEY_DOWN_0 + n (main row or keypad)
+    ECGV_EV_KEY_DOWN_1 = 26,
+    ECGV_EV_KEY_DOWN_2 = 27,
+    ECGV_EV_KEY_DOWN_3 = 28,
+    ECGV_EV_KEY_DOWN_4 = 29,
+    ECGV_EV_KEY_DOWN_5 = 30,
+    ECGV_EV_KEY_DOWN_6 = 31,
+    ECGV_EV_KEY_DOWN_7 = 32,
+    ECGV_EV_KEY_DOWN_8 = 33,
+    ECGV_EV_KEY_DOWN_9 = 34,
+    ECGV_EV_KEY_DOWN_ENTER = 35,
+    ECGV_EV_KEY_DOWN_BACKSPACE = 36
 };
 
+// Subscription masks (see ECObserverSubject::Attach)
+const ECEventMask ECGV_MASK_TIMER = ECEventBit(ECGV_EV_TIMER);
+const ECEventMask ECGV_MASK_KEY_DOWN =
+    ECEventBit(ECGV_EV_KEY_DOWN_UP) | ECEventBit(ECGV_EV_KEY_DOWN_DOWN) | ECEventBit(ECGV_EV_KEY_DOWN_LEFT) |
+    ECEventBit(ECGV_EV_KEY_DOWN_RIGHT) | ECEventBit(ECGV_EV_KEY_DOWN_ESCAPE) | ECEventBit(ECGV_EV_KEY_DOWN_Z) |
+    ECEventBit(ECGV_EV_KEY_DOWN_Y) | ECEventBit(ECGV_EV_KEY_DOWN_D) | ECEventBit(ECGV_EV_KEY_DOWN_SPACE) |
+    ECEventBit(ECGV_EV_KEY_DOWN_G) | ECEventBit(ECGV_EV_KEY_DOWN_ENTER) | ECEventBit(ECGV_EV_KEY_DOWN_BACKSPACE) |
+    (((ECEventBit(ECGV_EV_KEY_DOWN_9) << 1) - 1) & ~(ECEventBit(ECGV_EV_KEY_DOWN_0) - 1));   // digits
+const ECEventMask ECGV_MASK_KEY_UP =
+    ECEventBit(ECGV_EV_KEY_UP_UP) | ECEventBit(ECGV_EV_KEY_UP_DOWN) | ECEventBit(ECGV_EV_KEY_UP_LEFT) |
+    ECEventBit(ECGV_EV_KEY_UP_RIGHT) | ECEventBit(ECGV_EV_KEY_UP_ESCAPE) | ECEventBit(ECGV_EV_KEY_UP_Z) |
+    ECEventBit(ECGV_EV_KEY_UP_Y) | ECEventBit(ECGV_EV_KEY_UP_D) | ECEventBit(ECGV_EV_KEY_UP_SPACE) | ECEventBit(ECGV_EV_KEY_UP_G);
+const ECEventMask ECGV_MASK_MOUSE_BUTTONS = ECEventBit(ECGV_EV_MOUSE_BUTTON_DOWN) | ECEventBit(ECGV_EV_MOUSE_BUTTON_UP);
+const ECEventMask ECGV_MASK_MOUSE_MOVING = ECEventBit(ECGV_EV_MOUSE_MOVING);
+
 //***********************************************************
 // Pre-defined color
 
@@ -101,16 +129,21 @@ private:
 //
 // Note: ECGraphicViewImp implements *** Observer *** pattern
 // It is the subject that accepts observers.
-// Whenver something happens (i.e., a key is pressed), all observers
-// are notified through Observer's Notify function
-// then an observer would check for update (in this case, what key is pressed)
+// Whenver something happens (i.e., a key is pressed), the observers
+// subscribed to that kind of event are notified through Observer's Notify function
+// then an observer would check for update (in this case, what key is pressed).
+// Events nobody subscribed to are dropped without drawing anything, and a run of
+// queued mouse moves is delivered as one (read the cursor with GetCursorPosition)
 //
 
 class ECGraphicViewImp : public ECObserverSubject
 {
 public:
     // Create a view with size (width, height)
-    ECGraphicViewImp(int width, int height);
+    // offscreen: draw into a memory bitmap instead of a window. No display, keyboard,
+    // mouse or timer is used (works on a machine without a display server); frames
+    // are produced one at a time with RenderFrame instead of Show
+    ECGraphicViewImp(int width, int height, bool offscreen = false);
     virtual ~ECGraphicViewImp();
 
     // Show the view. This would enter a forever loop, until quit is set. To do things you want to do, implement code for event handling
@@ -119,6 +152,18 @@ public:
     // Set flag to redraw (or not). Invoke SetRedraw(true) after you make changes to the view
     void SetRedraw(bool f) { fRedraw = f; }
 
+    // Offscreen view: sends one timer event to the observers; true if they drew a frame
+    bool RenderFrame();
+    // Offscreen view: pixels of the last frame, RGBA, rows top to bottom (width * height * 4 bytes)
+    bool ReadFrame(std::vector<unsigned char>& rgba) const;
+    // Offscreen view: save the last frame as an image (the format follows the extension, e.g. .png)
+    bool SaveFrame(const std::string& path) const;
+    bool IsOffscreen() const { return offscreen; }
+    int GetFrameRate() const;
+
+    // Turn the drawing functions into no-ops, e.g. while fast-forwarding to a frame
+    void SetDrawingEnabled(bool f) { fDrawing = f; }
+
     // Access view properties
     int GetWith() const { return widthView; }
     int GetWidth() const { return widthView; }
@@ -134,6 +179,7 @@ public:
     void DrawLine(int x1, int y1, int x2, int y2, int thickness = 3, ECGVColor color = ECGV_BLACK);
     void DrawRectangle(int x1, int y1, int x2, int y2, int thickness = 3, ECGVColor color = ECGV_BLACK);
     void DrawFilledRectangle(int x1, int y1, int x2, int y2, ECGVColor color = ECGV_BLACK);
+    void DrawFilledRectangleRGB(int x1, int y1, int x2, int y2, unsigned char r, unsigned char g, unsigned char b);   // any color, e.g. for color scales
     void DrawCircle(int xcenter, int ycenter, double radius, int thickness = 3, ECGVColor color = ECGV_BLACK);
     void DrawFilledCircle(int xcenter, int ycenter, double radius, ECGVColor color = ECGV_BLACK);
     void DrawEllipse(int xcenter, int ycenter, double radiusx, double radiusy, int thickness = 3, ECGVColor color = ECGV_BLACK);
@@ -146,6 +192,8 @@ private:
     // Internal functions
     // Initialize and reset view
     void Init();
+    void InitOffscreen();
+    void InitFont();
     void Shutdown();
 
     // View utiltiles
@@ -154,6 +202,7 @@ private:
 
     // Process event
     ECGVEventType  WaitForEvent();
+    void CoalesceMouseMoves();
 
     // data members
     // size of view
@@ -163,6 +212,11 @@ private:
     // whether to redraw or not
     bool fRedraw;
 
+    // offscreen rendering, and whether the drawing functions draw at all
+    bool offscreen;
+    bool fDrawing;
+    ALLEGRO_BITMAP* frameBuffer;
+
     // keep track of what happened to view
     ECGVEventType evtCurrent;
 
@@ -0,0 +1,100 @@
+#pragma once
+//
+//  ECMpscRing.h
+//
+//  Bounded lock-free queue for many producer threads and one consumer
+//  (per-slot sequence numbers, as in D. Vyukov's bounded queue). Producers
+//  never block: TryPush fails when the ring is full. Every pushed item gets
+//  a position; positions are unique, increase in push order, and items are
+//  popped in position order
+//
+
+#ifndef ECMpscRing_h
+#define ECMpscRing_h
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+template <class T>
+class ECMpscRing
+{
+public:
+    // capacity is rounded up to a power of two
+    explicit ECMpscRing(size_t capacity = 4096) : cells(RoundUp(capacity)), mask(cells.size() - 1), popPos(0)
+    {
+        for (size_t i = 0; i < cells.size(); ++i) {
+            cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+        pushPos.store(0, std::memory_order_relaxed);
+    }
+
+    ECMpscRing(const ECMpscRing&) = delete;
+    ECMpscRing& operator=(const ECMpscRing&) = delete;
+
+    // Any thread. Returns false if the ring is full; pos gets the position of the item
+    bool TryPush(const T& item, uint64_t* pos = NULL)
+    {
+        uint64_t p = pushPos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[p & mask];
+            uint64_t seq = cell.seq.load(std::memory_order_acquire);
+            int64_t dif = (int64_t)seq - (int64_t)p;
+            if (dif == 0) {
+                if (pushPos.compare_exchange_weak(p, p + 1, std::memory_order_relaxed)) {
+                    cell.item = item;
+                    cell.seq.store(p + 1, std::memory_order_release);
+                    if (pos) *pos = p;
+                    return true;
+                }
+            }
+            else if (dif < 0) {
+                return false;   // full
+            }
+            else {
+                p = pushPos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer thread only. Returns false if nothing (complete) is queued
+    bool TryPop(T& item, uint64_t* pos = NULL)
+    {
+        Cell& cell = cells[popPos & mask];
+        uint64_t seq = cell.seq.load(std::memory_order_acquire);
+        if ((int64_t)seq - (int64_t)(popPos + 1) < 0) {
+            return false;
+        }
+        item = cell.item;
+        cell.seq.store(popPos + mask + 1, std::memory_order_release);
+        if (pos) *pos = popPos;
+        popPos++;
+        return true;
+    }
+
+    size_t GetCapacity() const { return mask + 1; }
+
+private:
+    struct Cell
+    {
+        std::atomic<uint64_t> seq;
+        T item;
+
+        Cell() : seq(0), item() {}
+    };
+
+    static size_t RoundUp(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        return size;
+    }
+
+    std::vector<Cell> cells;
+    size_t mask;
+    alignas(64) std::atomic<uint64_t> pushPos;
+    alignas(64) uint64_t popPos;
+};
+
+#endif
@@ -14,6 +14,18 @@
 #include <vector>
 #include <algorithm>
 #include <iostream>
+#include <cstdint>
+
+//********************************************
+// Event kinds an observer subscribes to, one bit per kind (kinds 0..63)
+
+typedef uint64_t ECEventMask;
+const ECEventMask EC_ALL_EVENTS = ~0ULL;
+
+constexpr ECEventMask ECEventBit(int kind)
+{
+    return (kind >= 0 && kind < 64) ? (1ULL << kind) : 0;
+}
 
 //********************************************
 // Observer design pattern: observer interface
@@ -23,6 +35,9 @@ class ECObserver
 public:
     virtual ~ECObserver() {}
     virtual void Update() = 0;
+
+    // Kinds of event this observer wants; Attach uses it unless given a mask
+    virtual ECEventMask GetEventMask() const { return EC_ALL_EVENTS; }
 };
 
 //********************************************
@@ -31,28 +46,83 @@ public:
 class ECObserverSubject
 {
 public:
-    ECObserverSubject() {}
+    ECObserverSubject() : subscribedMask(0) {}
     virtual ~ECObserverSubject() {}
     void Attach(ECObserver* pObs)
+    {
+        Attach(pObs, pObs->GetEventMask());
+    }
+    // Attach with an explicit subscription (attaching again only changes the mask)
+    void Attach(ECObserver* pObs, ECEventMask mask)
     {
         //std::cout << "Adding an observer.\n";
-        listObservers.push_back(pObs);
+        for (auto& sub : listObservers)
+        {
+            if (sub.observer == pObs)
+            {
+                sub.mask = mask;
+                updateMask();
+                return;
+            }
+        }
+        listObservers.push_back(Subscription{ pObs, mask });
+        subscribedMask |= mask;
     }
     void Detach(ECObserver* pObs)
     {
-        listObservers.erase(std::remove(listObservers.begin(), listObservers.end(), pObs), listObservers.end());
+        listObservers.erase(std::remove_if(listObservers.begin(), listObservers.end(),
+            [pObs](const Subscription& sub) { return sub.observer == pObs; }), listObservers.end());
+        updateMask();
     }
+    // Every observer, whatever it subscribed to
     void Notify()
     {
         //std::cout << "Notify: number of observer: " << listObservers.size() << std::endl;
         for (unsigned int i = 0; i < listObservers.size(); ++i)
         {
-            listObservers[i]->Update();
+            listObservers[i].observer->Update();
+        }
+    }
+    // Only the observers subscribed to this kind of event
+    void Notify(int kind)
+    {
+        ECEventMask bit = ECEventBit(kind);
+        if ((subscribedMask & bit) == 0)
+        {
+            return;
+        }
+        for (unsigned int i = 0; i < listObservers.size(); ++i)
+        {
+            if (listObservers[i].mask & bit)
+            {
+                listObservers[i].observer->Update();
+            }
         }
     }
+    // Is anyone subscribed to this kind of event?
+    bool HasSubscribers(int kind) const
+    {
+        return (subscribedMask & ECEventBit(kind)) != 0;
+    }
 
 private:
-    std::vector<ECObserver*> listObservers;
+    struct Subscription
+    {
+        ECObserver* observer;
+        ECEventMask mask;
+    };
+
+    void updateMask()
+    {
+        subscribedMask = 0;
+        for (const auto& sub : listObservers)
+        {
+            subscribedMask |= sub.mask;
+        }
+    }
+
+    std::vector<Subscription> listObservers;
+    ECEventMask subscribedMask;    // union of all subscriptions
 };
 
 
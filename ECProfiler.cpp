@@ -0,0 +1,190 @@
+//
+//  ECProfiler.cpp
+//
+
+#include "ECProfiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+static const char* PHASE_NAMES[EC_PHASE_COUNT] =
+{
+    "Simulate",
+    "handlePassengers",
+    "handleStop",
+    "moveElevator",
+    "determineDirection",
+    "Observer::simulate",
+    "Observer::render"
+};
+
+const char* ECProfiler::GetPhaseName(int phase)
+{
+    return (phase >= 0 && phase < EC_PHASE_COUNT) ? PHASE_NAMES[phase] : "unknown";
+}
+
+#if defined(EC_ENABLE_PROFILING)
+
+bool ECProfiler::traceEnabled = false;
+
+// all thread buffers ever created; kept alive until exit so that a report
+// can still be printed after worker threads finished
+static mutex registryLock;
+static vector<unique_ptr<ECProfileThreadData>> registry;
+
+bool ECProfiler::IsCompiledIn()
+{
+    return true;
+}
+
+void ECProfiler::SetTraceEnabled(bool f)
+{
+    traceEnabled = f;
+}
+
+ECProfileThreadData* ECProfiler::RegisterThread()
+{
+    lock_guard<mutex> guard(registryLock);
+    registry.push_back(unique_ptr<ECProfileThreadData>(new ECProfileThreadData()));
+    registry.back()->threadId = (int)registry.size();
+    return registry.back().get();
+}
+
+// nanoseconds per tick of ECProfiler::Now
+static double NanosPerTick()
+{
+#if defined(EC_PROFILER_RDTSC)
+    static double nsPerTick = 0.0;
+    if (nsPerTick == 0.0) {
+        auto t0 = chrono::steady_clock::now();
+        uint64_t c0 = ECProfiler::Now();
+        this_thread::sleep_for(chrono::milliseconds(20));
+        uint64_t c1 = ECProfiler::Now();
+        auto t1 = chrono::steady_clock::now();
+        double ns = (double)chrono::duration_cast<chrono::nanoseconds>(t1 - t0).count();
+        nsPerTick = ns / (double)max<uint64_t>(1, c1 - c0);
+    }
+    return nsPerTick;
+#else
+    return 1.0;
+#endif
+}
+
+// upper edge (ticks) of a histogram bucket, see ECProfiler::BucketOf
+static double BucketUpperEdge(int b)
+{
+    if (b < 8) return b + 1;
+    int lg = b / 4, sub = b % 4;
+    return ldexp(5.0 + sub, lg - 2);
+}
+
+// duration (ns) below which the given fraction of samples fall, from a histogram
+static double Percentile(const ECProfilePhaseStats& stats, double fraction, double nsPerTick)
+{
+    uint64_t target = (uint64_t)(fraction * stats.count);
+    uint64_t seen = 0;
+    for (int b = 0; b < EC_PROFILE_BUCKETS; ++b) {
+        seen += stats.histogram[b];
+        if (seen > target) {
+            return min(BucketUpperEdge(b), (double)stats.maxTicks) * nsPerTick;
+        }
+    }
+    return (double)stats.maxTicks * nsPerTick;
+}
+
+void ECProfiler::PrintReport(ostream& out)
+{
+    double nsPerTick = NanosPerTick();
+
+    // merge all threads
+    ECProfilePhaseStats merged[EC_PHASE_COUNT];
+    {
+        lock_guard<mutex> guard(registryLock);
+        for (const auto& data : registry) {
+            for (int p = 0; p < EC_PHASE_COUNT; ++p) {
+                const ECProfilePhaseStats& s = data->phases[p];
+                merged[p].count += s.count;
+                merged[p].totalTicks += s.totalTicks;
+                merged[p].maxTicks = max(merged[p].maxTicks, s.maxTicks);
+                for (int b = 0; b < EC_PROFILE_BUCKETS; ++b) {
+                    merged[p].histogram[b] += s.histogram[b];
+                }
+            }
+        }
+    }
+
+    out << left << setw(22) << "Phase" << right << setw(12) << "Count" << setw(12) << "Total ms"
+        << setw(12) << "Mean ns" << setw(12) << "p50 ns" << setw(12) << "p99 ns" << setw(12) << "Max ns" << "\n";
+    for (int p = 0; p < EC_PHASE_COUNT; ++p) {
+        const ECProfilePhaseStats& s = merged[p];
+        if (s.count == 0) continue;
+        double totalNs = s.totalTicks * nsPerTick;
+        out << left << setw(22) << GetPhaseName(p) << right << setw(12) << s.count
+            << setw(12) << fixed << setprecision(2) << totalNs / 1e6
+            << setw(12) << setprecision(0) << totalNs / s.count
+            << setw(12) << Percentile(s, 0.50, nsPerTick) << setw(12) << Percentile(s, 0.99, nsPerTick)
+            << setw(12) << s.maxTicks * nsPerTick << "\n";
+    }
+    out.flush();
+}
+
+bool ECProfiler::WriteChromeTrace(const string& path)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == NULL) {
+        return false;
+    }
+
+    double nsPerTick = NanosPerTick();
+    lock_guard<mutex> guard(registryLock);
+
+    // timestamps relative to the earliest sample
+    uint64_t origin = UINT64_MAX;
+    for (const auto& data : registry) {
+        if (!data->trace.empty()) origin = min(origin, data->trace.front().start);
+    }
+
+    fprintf(file, "{\"traceEvents\":[\n");
+    bool first = true;
+    for (const auto& data : registry) {
+        for (const auto& ev : data->trace) {
+            fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                first ? "" : ",\n", GetPhaseName(ev.phase), data->threadId,
+                (ev.start - origin) * nsPerTick / 1000.0, ev.duration * nsPerTick / 1000.0);
+            first = false;
+        }
+    }
+    fprintf(file, "\n],\"displayTimeUnit\":\"ns\"}\n");
+    fclose(file);
+    return true;
+}
+
+#else
+
+bool ECProfiler::IsCompiledIn()
+{
+    return false;
+}
+
+void ECProfiler::SetTraceEnabled(bool)
+{
+}
+
+void ECProfiler::PrintReport(ostream& out)
+{
+    out << "Profiling is not compiled in (define EC_ENABLE_PROFILING)" << endl;
+}
+
+bool ECProfiler::WriteChromeTrace(const string&)
+{
+    return false;
+}
+
+#endif
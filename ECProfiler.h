@@ -0,0 +1,181 @@
+#pragma once
+//
+//  ECProfiler.h
+//
+//  Scoped timers for the simulation hot path. Each thread accumulates into
+//  its own buffers (no locking per sample); results are merged when a report
+//  is printed. Everything compiles to nothing unless EC_ENABLE_PROFILING is
+//  defined, e.g. /D EC_ENABLE_PROFILING (MSVC) or -DEC_ENABLE_PROFILING (gcc)
+//
+
+#ifndef ECProfiler_h
+#define ECProfiler_h
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(EC_ENABLE_PROFILING)
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define EC_PROFILER_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define EC_PROFILER_RDTSC 1
+#else
+#include <chrono>
+#endif
+#endif
+
+//********************************************
+// Instrumented phases
+
+enum EC_PROFILE_PHASE
+{
+    EC_PHASE_SIMULATE = 0,          // one ECElevatorSim::Simulate step
+    EC_PHASE_HANDLE_PASSENGERS,
+    EC_PHASE_HANDLE_STOP,
+    EC_PHASE_MOVE_ELEVATOR,
+    EC_PHASE_DETERMINE_DIRECTION,
+    EC_PHASE_OBSERVER_SIMULATE,     // simulation part of ElevatorObserver::Update
+    EC_PHASE_OBSERVER_RENDER,       // drawing part of ElevatorObserver::Update
+    EC_PHASE_COUNT
+};
+
+// histogram buckets: four per power of two of the duration in ticks (exact below 8 ticks)
+const int EC_PROFILE_BUCKETS = 256;
+
+struct ECProfilePhaseStats
+{
+    uint64_t count = 0;
+    uint64_t totalTicks = 0;
+    uint64_t maxTicks = 0;
+    uint64_t histogram[EC_PROFILE_BUCKETS] = {};
+};
+
+struct ECProfileTraceEvent
+{
+    uint64_t start;     // ticks
+    uint64_t duration;  // ticks
+    int phase;
+};
+
+struct ECProfileThreadData
+{
+    int threadId = 0;
+    ECProfilePhaseStats phases[EC_PHASE_COUNT];
+    std::vector<ECProfileTraceEvent> trace;
+};
+
+//********************************************
+// Profiler front end. Report/export functions exist in every build and do
+// nothing (besides saying so) when profiling is compiled out
+
+class ECProfiler
+{
+public:
+    static bool IsCompiledIn();
+    static const char* GetPhaseName(int phase);
+
+    // Also keep every sample for the Chrome trace export (bounded per thread)
+    static void SetTraceEnabled(bool f);
+
+    // Per-phase count, total, mean, p50/p99 (from the histograms) and max
+    static void PrintReport(std::ostream& out);
+
+    // Chrome trace-event JSON, viewable in chrome://tracing or Perfetto
+    static bool WriteChromeTrace(const std::string& path);
+
+#if defined(EC_ENABLE_PROFILING)
+    static uint64_t Now()
+    {
+#if defined(EC_PROFILER_RDTSC)
+        return __rdtsc();
+#else
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    static void Record(int phase, uint64_t start, uint64_t end)
+    {
+        ECProfileThreadData& data = GetThreadData();
+        ECProfilePhaseStats& stats = data.phases[phase];
+        uint64_t ticks = end - start;
+        stats.count++;
+        stats.totalTicks += ticks;
+        if (ticks > stats.maxTicks) stats.maxTicks = ticks;
+        stats.histogram[BucketOf(ticks)]++;
+        if (traceEnabled && data.trace.size() < MAX_TRACE_EVENTS) {
+            data.trace.push_back(ECProfileTraceEvent{ start, ticks, phase });
+        }
+    }
+
+private:
+    static const size_t MAX_TRACE_EVENTS = 4 * 1024 * 1024;
+
+    static int BucketOf(uint64_t ticks)
+    {
+        if (ticks < 8) return (int)ticks;
+        int lg = Log2(ticks);
+        return lg * 4 + (int)((ticks >> (lg - 2)) & 3);
+    }
+
+    static int Log2(uint64_t x)
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+        unsigned long b;
+        _BitScanReverse64(&b, x);
+        return (int)b;
+#elif defined(__GNUC__)
+        return 63 - __builtin_clzll(x);
+#else
+        int b = 0;
+        while (x > 1) {
+            x >>= 1;
+            b++;
+        }
+        return b;
+#endif
+    }
+
+    static ECProfileThreadData& GetThreadData()
+    {
+        thread_local ECProfileThreadData* data = NULL;
+        if (data == NULL) {
+            data = RegisterThread();
+        }
+        return *data;
+    }
+    static ECProfileThreadData* RegisterThread();
+
+    static bool traceEnabled;
+#endif
+};
+
+#if defined(EC_ENABLE_PROFILING)
+
+// Times the enclosing scope
+class ECProfileScope
+{
+public:
+    explicit ECProfileScope(int phaseIn) : phase(phaseIn), start(ECProfiler::Now()) {}
+    ~ECProfileScope() { ECProfiler::Record(phase, start, ECProfiler::Now()); }
+
+private:
+    int phase;
+    uint64_t start;
+};
+
+#define EC_PROFILE_JOIN2(a, b) a##b
+#define EC_PROFILE_JOIN(a, b) EC_PROFILE_JOIN2(a, b)
+#define EC_PROFILE_SCOPE(phase) ECProfileScope EC_PROFILE_JOIN(ecProfileScope, __LINE__)(phase)
+
+#else
+
+#define EC_PROFILE_SCOPE(phase) ((void)0)
+
+#endif
+
+#endif
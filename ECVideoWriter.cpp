@@ -0,0 +1,117 @@
+#include "ECVideoWriter.h"
+#include <algorithm>
+
+// BT.601 limited range, 8-bit fixed point
+static unsigned char ToY(int r, int g, int b) {
+    return (unsigned char)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+static unsigned char ToCb(int r, int g, int b) {
+    return (unsigned char)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+static unsigned char ToCr(int r, int g, int b) {
+    return (unsigned char)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+// ECY4MWriter Implementation
+ECY4MWriter::ECY4MWriter() : file(NULL), width(0), height(0), numFrames(0) {
+}
+
+ECY4MWriter::~ECY4MWriter() {
+    Close();
+}
+
+bool ECY4MWriter::Open(const std::string& path, int widthIn, int heightIn, int frameRate, bool writeHeader) {
+    Close();
+    file = fopen(path.c_str(), "wb");
+    if (file == NULL) {
+        return false;
+    }
+    width = widthIn;
+    height = heightIn;
+    numFrames = 0;
+    if (writeHeader) {
+        fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, frameRate);
+    }
+    return true;
+}
+
+void ECY4MWriter::Close() {
+    if (file != NULL) {
+        fclose(file);
+        file = NULL;
+    }
+}
+
+bool ECY4MWriter::WriteFrame(const std::vector<unsigned char>& rgba) {
+    if (file == NULL || rgba.size() < (size_t)width * height * 4) {
+        return false;
+    }
+
+    int chromaW = (width + 1) / 2, chromaH = (height + 1) / 2;
+    size_t lumaSize = (size_t)width * height, chromaSize = (size_t)chromaW * chromaH;
+    planes.resize(lumaSize + 2 * chromaSize);
+    unsigned char* lumaPlane = planes.data();
+    unsigned char* cbPlane = lumaPlane + lumaSize;
+    unsigned char* crPlane = cbPlane + chromaSize;
+
+    for (int y = 0; y < height; ++y) {
+        const unsigned char* px = rgba.data() + (size_t)y * width * 4;
+        for (int x = 0; x < width; ++x, px += 4) {
+            lumaPlane[(size_t)y * width + x] = ToY(px[0], px[1], px[2]);
+        }
+    }
+
+    //chroma of every 2x2 block from its average color (edge blocks use what exists)
+    for (int cy = 0; cy < chromaH; ++cy) {
+        for (int cx = 0; cx < chromaW; ++cx) {
+            int r = 0, g = 0, b = 0, n = 0;
+            for (int y = cy * 2; y < std::min(height, cy * 2 + 2); ++y) {
+                for (int x = cx * 2; x < std::min(width, cx * 2 + 2); ++x) {
+                    const unsigned char* px = rgba.data() + ((size_t)y * width + x) * 4;
+                    r += px[0];
+                    g += px[1];
+                    b += px[2];
+                    n++;
+                }
+            }
+            r /= n;
+            g /= n;
+            b /= n;
+            cbPlane[(size_t)cy * chromaW + cx] = ToCb(r, g, b);
+            crPlane[(size_t)cy * chromaW + cx] = ToCr(r, g, b);
+        }
+    }
+
+    fputs("FRAME\n", file);
+    if (fwrite(planes.data(), 1, planes.size(), file) != planes.size()) {
+        return false;
+    }
+    numFrames++;
+    return true;
+}
+
+bool ECY4MWriter::AppendPart(const std::string& path, const std::string& partPath) {
+    FILE* part = fopen(partPath.c_str(), "rb");
+    if (part == NULL) {
+        return false;
+    }
+    FILE* out = fopen(path.c_str(), "ab");
+    if (out == NULL) {
+        fclose(part);
+        return false;
+    }
+
+    std::vector<char> buffer(1 << 20);
+    size_t n;
+    bool ok = true;
+    while ((n = fread(buffer.data(), 1, buffer.size(), part)) > 0) {
+        if (fwrite(buffer.data(), 1, n, out) != n) {
+            ok = false;
+            break;
+        }
+    }
+    fclose(part);
+    if (fclose(out) != 0) ok = false;
+    remove(partPath.c_str());
+    return ok;
+}
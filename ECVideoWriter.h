@@ -0,0 +1,41 @@
+#pragma once
+#ifndef ECVideoWriter_h
+#define ECVideoWriter_h
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//*****************************************************************************
+// Raw YUV4MPEG2 (.y4m) stream writer: 4:2:0 chroma, BT.601 limited range.
+// Plays in mpv/VLC and converts with e.g. "ffmpeg -i run.y4m run.mp4".
+// A stream can be written in pieces (header only on the first one) and the
+// pieces joined in order afterwards
+
+class ECY4MWriter
+{
+public:
+    ECY4MWriter();
+    ~ECY4MWriter();
+    ECY4MWriter(const ECY4MWriter&) = delete;
+    ECY4MWriter& operator=(const ECY4MWriter&) = delete;
+
+    bool Open(const std::string& path, int width, int height, int frameRate, bool writeHeader = true);
+    void Close();
+
+    // One frame of RGBA pixels, rows top to bottom (width * height * 4 bytes)
+    bool WriteFrame(const std::vector<unsigned char>& rgba);
+
+    int GetNumFrames() const { return numFrames; }
+
+    // Append the piece at partPath to the stream at path (and delete the piece)
+    static bool AppendPart(const std::string& path, const std::string& partPath);
+
+private:
+    FILE* file;
+    int width, height;
+    int numFrames;
+    std::vector<unsigned char> planes;   // Y, then Cb, then Cr
+};
+
+#endif
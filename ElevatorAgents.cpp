@@ -0,0 +1,523 @@
+#include "ElevatorAgents.h"
+#include "ElevatorStrategyRegistry.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <vector>
+
+#ifdef EC_HAS_AGENT_MODEL
+#include <coroutine>
+#include <exception>
+
+namespace {
+
+//*****************************************************************************
+// Pool of coroutine frames: one free list per size class (multiples of 64 bytes
+// up to 2 KB) carved from 256 KB blocks; larger frames come from the heap.
+// Every frame starts with a header naming its pool and class, so it can be freed
+// without knowing where it came from
+
+class ElevatorFramePool
+{
+public:
+    ElevatorFramePool() : bytesHeld(0), maxFrameSize(0) {
+        std::fill(freeLists, freeLists + NUM_CLASSES, (FreeFrame*)NULL);
+    }
+    ElevatorFramePool(const ElevatorFramePool&) = delete;
+    ElevatorFramePool& operator=(const ElevatorFramePool&) = delete;
+    ~ElevatorFramePool() {
+        for (char* block : blocks) {
+            ::operator delete(block);
+        }
+    }
+
+    void* Allocate(size_t size) {
+        maxFrameSize = std::max(maxFrameSize, size);
+        size_t total = size + HEADER_SIZE;
+        int sizeClass = (int)((total + CLASS_STEP - 1) / CLASS_STEP) - 1;
+        char* frame;
+        if (sizeClass >= NUM_CLASSES) {
+            frame = (char*)::operator new(total);
+            sizeClass = LARGE_CLASS;
+        }
+        else {
+            if (freeLists[sizeClass] == NULL) {
+                carve(sizeClass);
+            }
+            FreeFrame* head = freeLists[sizeClass];
+            freeLists[sizeClass] = head->next;
+            frame = (char*)head;
+        }
+        Header* header = (Header*)frame;
+        header->pool = this;
+        header->sizeClass = sizeClass;
+        return frame + HEADER_SIZE;
+    }
+
+    static void Free(void* ptr) {
+        char* frame = (char*)ptr - HEADER_SIZE;
+        Header* header = (Header*)frame;
+        if (header->sizeClass == LARGE_CLASS) {
+            ::operator delete(frame);
+            return;
+        }
+        ElevatorFramePool* pool = header->pool;
+        FreeFrame* node = (FreeFrame*)frame;
+        node->next = pool->freeLists[header->sizeClass];
+        pool->freeLists[header->sizeClass] = node;
+    }
+
+    size_t GetBytesHeld() const { return bytesHeld; }
+    size_t GetMaxFrameSize() const { return maxFrameSize; }
+
+private:
+    static const size_t HEADER_SIZE = 16;   // keeps frames 16-byte aligned
+    static const size_t CLASS_STEP = 64;
+    static const int NUM_CLASSES = 32;
+    static const int LARGE_CLASS = -1;
+    static const size_t BLOCK_SIZE = 256 * 1024;
+
+    struct Header
+    {
+        ElevatorFramePool* pool;
+        int sizeClass;
+    };
+    static_assert(sizeof(Header) <= HEADER_SIZE, "frame header too large");
+
+    struct FreeFrame
+    {
+        FreeFrame* next;
+    };
+
+    // carve helper method, cuts a new block into frames of a class
+    void carve(int sizeClass) {
+        size_t frameSize = (sizeClass + 1) * CLASS_STEP;
+        char* block = (char*)::operator new(BLOCK_SIZE);
+        blocks.push_back(block);
+        bytesHeld += BLOCK_SIZE;
+        for (size_t offset = 0; offset + frameSize <= BLOCK_SIZE; offset += frameSize) {
+            FreeFrame* node = (FreeFrame*)(block + offset);
+            node->next = freeLists[sizeClass];
+            freeLists[sizeClass] = node;
+        }
+    }
+
+    FreeFrame* freeLists[NUM_CLASSES];
+    std::vector<char*> blocks;
+    size_t bytesHeld;
+    size_t maxFrameSize;
+};
+
+class ElevatorAgentWorld;
+void* AllocateAgentFrame(ElevatorAgentWorld& world, size_t size);
+
+//*****************************************************************************
+// An agent: a coroutine started (and then owned) by the world. It runs until it
+// first waits, and its frame is freed as soon as it finishes. Agents are member
+// functions of the world, so their frames come from the world's pool
+
+struct ElevatorAgentTask
+{
+    struct promise_type
+    {
+        template <class... Args>
+        static void* operator new(size_t size, ElevatorAgentWorld& world, Args&&...) {
+            return AllocateAgentFrame(world, size);
+        }
+        static void operator delete(void* ptr, size_t) { ElevatorFramePool::Free(ptr); }
+
+        ElevatorAgentTask get_return_object() { return ElevatorAgentTask{ std::coroutine_handle<promise_type>::from_promise(*this) }; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+//*****************************************************************************
+// Runs the simulator and the agents step by step. Agents wait in slots: on a
+// request reaching a state (boarded/alighted), on a time, or both. The simulator
+// events only mark the slot ready; agents are resumed after the step, never from
+// inside an observer callback
+
+class ElevatorAgentWorld : public ECObserver
+{
+public:
+    ElevatorAgentWorld(const ElevatorTrace& trace, const ElevatorRunOptions& options, const ElevatorAgentOptions& agentOptions);
+    ElevatorAgentWorld(const ElevatorAgentWorld&) = delete;
+    ElevatorAgentWorld& operator=(const ElevatorAgentWorld&) = delete;
+    ~ElevatorAgentWorld();
+
+    void Run();
+
+    void Update() override;
+    ECEventMask GetEventMask() const override { return ECEventBit(EC_SIM_EV_BOARDED) | ECEventBit(EC_SIM_EV_ALIGHTED); }
+
+    ECElevatorSim& GetSim() { return sim; }
+    ElevatorFramePool& GetFramePool() { return framePool; }
+    const ElevatorAgentStats& GetStats() const { return stats; }
+
+private:
+    static const uint32_t NO_SLOT = UINT32_MAX;
+
+    struct WaitSlot
+    {
+        std::coroutine_handle<> agent;
+        uint32_t gen = 0;           // bumped whenever the wait ends, so stale timers are ignored
+        uint32_t nextFree = NO_SLOT;
+        uint32_t request = NO_SLOT;
+        int waitFor = 0;            // EC_SIM_EVENT_TYPE
+        bool woken = false;         // ended by the event (not the time)
+    };
+
+    struct Timer
+    {
+        int time;
+        uint64_t seq;
+        uint32_t slot;
+        uint32_t gen;
+        bool operator>(const Timer& rhs) const { return time != rhs.time ? time > rhs.time : seq > rhs.seq; }
+    };
+
+    // Suspends an agent until request reaches the state of event waitFor, or until
+    // deadline (INT_MAX: no deadline; no request: just the time). Resumes with true
+    // if the event came
+    struct WaitAwaiter
+    {
+        ElevatorAgentWorld& world;
+        uint32_t request;
+        int waitFor;
+        int deadline;
+        uint32_t slot = NO_SLOT;
+        bool immediate = false;
+
+        bool await_ready() {
+            if (request != NO_SLOT && world.hasReached(request, waitFor)) {
+                immediate = true;
+                return true;
+            }
+            return deadline <= world.now;
+        }
+        void await_suspend(std::coroutine_handle<> agent) { slot = world.suspend(agent, request, waitFor, deadline); }
+        bool await_resume() {
+            if (slot == NO_SLOT) return immediate;
+            return world.release(slot);
+        }
+    };
+
+    WaitAwaiter waitFor(uint32_t request, int event, int deadline) { return WaitAwaiter{ *this, request, event, deadline }; }
+    WaitAwaiter sleepUntil(int time) { return WaitAwaiter{ *this, NO_SLOT, 0, time }; }
+
+    // A passenger, or a group traveling together: order[begin .. begin+count-1]
+    ElevatorAgentTask passenger(uint32_t begin, uint32_t count);
+
+    bool hasReached(uint32_t request, int event) const;
+    uint32_t suspend(std::coroutine_handle<> agent, uint32_t request, int event, int deadline);
+    bool release(uint32_t slot);
+    void resume(std::coroutine_handle<> agent);
+    void spawnAgents(size_t& next);
+    void fireTimers();
+    void drainReady();
+    int patienceOf(uint32_t request) const;
+    int& waitingAt(int floor);
+    void withdrawGroup(uint32_t begin, uint32_t count);
+
+    const ElevatorTrace& trace;
+    const ElevatorAgentOptions& agentOptions;
+    // pool before the simulator and the slots: frames of the agents still waiting are freed into it
+    ElevatorFramePool framePool;
+    ECElevatorSim sim;
+    int now;
+
+    std::vector<uint32_t> order;         // passenger requests by time (handles)
+    std::vector<WaitSlot> slots;
+    uint32_t freeSlot;
+    std::vector<uint32_t> waiterOf;      // slot waiting on each request
+    std::vector<Timer> timers;           // min-heap
+    uint64_t timerSeq;
+    std::vector<uint32_t> ready;
+    std::vector<int> waitingCount;       // passengers of agents waiting per floor (0: outside the building)
+    long long numAlive;
+
+    ElevatorAgentStats stats;
+};
+
+void* AllocateAgentFrame(ElevatorAgentWorld& world, size_t size) {
+    return world.GetFramePool().Allocate(size);
+}
+
+ElevatorAgentWorld::ElevatorAgentWorld(const ElevatorTrace& traceIn, const ElevatorRunOptions& options, const ElevatorAgentOptions& agentOptionsIn)
+    : trace(traceIn), agentOptions(agentOptionsIn),
+      sim(traceIn.numFloors, traceIn.requests, ElevatorStrategyRegistry::Instance().Create(options.strategy)),
+      now(0), freeSlot(NO_SLOT), waiterOf(traceIn.requests.size(), NO_SLOT), timerSeq(0),
+      waitingCount(traceIn.numFloors + 1, 0), numAlive(0) {
+    sim.SetEventLog(options.eventLog);
+    sim.SetParkingStrategy(CreateParkingStrategy(options.parking, trace.numFloors, options.parkingParams));
+    sim.SetRetainResults(true);   // hasReached asks about finished requests
+    sim.Attach(this);
+
+    //handles are the positions in the trace; maintenance requests get no agent
+    for (uint32_t i = 0; i < (uint32_t)trace.requests.size(); ++i) {
+        const ECElevatorSimRequest& req = trace.requests[i];
+        if (!req.IsMaintenanceStart() && !req.IsMaintenanceEnd()) {
+            order.push_back(i);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return trace.requests[a].GetTime() < trace.requests[b].GetTime();
+    });
+}
+
+ElevatorAgentWorld::~ElevatorAgentWorld() {
+    //agents still waiting at the end of the run
+    for (WaitSlot& slot : slots) {
+        if (slot.agent) {
+            slot.agent.destroy();
+        }
+    }
+    sim.Detach(this);
+}
+
+void ElevatorAgentWorld::Run() {
+    size_t next = 0;
+    for (now = 0; now < trace.lenSim; ++now) {
+        sim.Simulate(now);
+        spawnAgents(next);
+        fireTimers();
+        drainReady();
+    }
+    stats.frameBytes = framePool.GetBytesHeld();
+    stats.maxFrameSize = framePool.GetMaxFrameSize();
+}
+
+void ElevatorAgentWorld::Update() {
+    const ElevatorEventRecord& rec = sim.GetCurrEvent();
+    if (rec.request >= waiterOf.size() || waiterOf[rec.request] == NO_SLOT) return;
+
+    WaitSlot& slot = slots[waiterOf[rec.request]];
+    if (slot.waitFor != rec.type) return;
+    slot.woken = true;
+    slot.gen++;
+    ready.push_back(waiterOf[rec.request]);
+    waiterOf[rec.request] = NO_SLOT;
+}
+
+// hasReached helper method, whether request is past waiting (boarded) or riding (alighted)
+bool ElevatorAgentWorld::hasReached(uint32_t request, int event) const {
+    ElevatorRequestResult result;
+    if (!sim.GetResult(request, result)) return false;
+    if (event == EC_SIM_EV_BOARDED) {
+        return result.state == EC_REQUEST_RIDING || result.state == EC_REQUEST_SERVICED;
+    }
+    return result.state == EC_REQUEST_SERVICED;
+}
+
+// suspend helper method, parks an agent in a free slot
+uint32_t ElevatorAgentWorld::suspend(std::coroutine_handle<> agent, uint32_t request, int event, int deadline) {
+    uint32_t index = freeSlot;
+    if (index == NO_SLOT) {
+        index = (uint32_t)slots.size();
+        slots.push_back(WaitSlot());
+    }
+    else {
+        freeSlot = slots[index].nextFree;
+    }
+
+    WaitSlot& slot = slots[index];
+    slot.agent = agent;
+    slot.request = request;
+    slot.waitFor = event;
+    slot.woken = false;
+    if (request != NO_SLOT) {
+        waiterOf[request] = index;
+    }
+    if (deadline != INT_MAX) {
+        timers.push_back(Timer{ deadline, timerSeq++, index, slot.gen });
+        std::push_heap(timers.begin(), timers.end(), std::greater<Timer>());
+    }
+    return index;
+}
+
+// release helper method, frees the slot of a resumed agent; true if the event ended the wait
+bool ElevatorAgentWorld::release(uint32_t index) {
+    WaitSlot& slot = slots[index];
+    bool woken = slot.woken;
+    slot.agent = nullptr;
+    slot.gen++;
+    slot.nextFree = freeSlot;
+    freeSlot = index;
+    return woken;
+}
+
+void ElevatorAgentWorld::resume(std::coroutine_handle<> agent) {
+    stats.numResumes++;
+    agent.resume();
+}
+
+// spawnAgents helper method, starts the agents of the requests made at this step
+void ElevatorAgentWorld::spawnAgents(size_t& next) {
+    while (next < order.size() && trace.requests[order[next]].GetTime() <= now) {
+        uint32_t begin = (uint32_t)next;
+        const ECElevatorSimRequest& first = trace.requests[order[next++]];
+        int maxGroup = agentOptions.groupTravel ? std::max(1, agentOptions.maxGroupSize) : 1;
+        while (next < order.size() && next - begin < (size_t)maxGroup) {
+            const ECElevatorSimRequest& req = trace.requests[order[next]];
+            if (req.GetTime() != first.GetTime() || req.GetFloorSrc() != first.GetFloorSrc() || req.GetFloorDest() != first.GetFloorDest()) break;
+            next++;
+        }
+        resume(passenger(begin, (uint32_t)next - begin).handle);
+    }
+}
+
+// fireTimers helper method, ends the waits whose time has come
+void ElevatorAgentWorld::fireTimers() {
+    while (!timers.empty() && timers.front().time <= now) {
+        std::pop_heap(timers.begin(), timers.end(), std::greater<Timer>());
+        Timer timer = timers.back();
+        timers.pop_back();
+
+        WaitSlot& slot = slots[timer.slot];
+        if (slot.gen != timer.gen) continue;   // ended by its event already
+        if (slot.request != NO_SLOT) {
+            waiterOf[slot.request] = NO_SLOT;
+        }
+        slot.gen++;
+        ready.push_back(timer.slot);
+    }
+}
+
+void ElevatorAgentWorld::drainReady() {
+    for (size_t i = 0; i < ready.size(); ++i) {
+        resume(slots[ready[i]].agent);
+    }
+    ready.clear();
+}
+
+// patienceOf helper method, patience of a passenger: 1/2 to 3/2 of the average, fixed per request
+int ElevatorAgentWorld::patienceOf(uint32_t request) const {
+    if (agentOptions.patience <= 0) return INT_MAX;
+    uint32_t h = request * 0x9E3779B1u;
+    h ^= h >> 15;
+    h *= 0x85EBCA77u;
+    h ^= h >> 13;
+    return agentOptions.patience / 2 + (int)(h % (uint32_t)(agentOptions.patience + 1));
+}
+
+int& ElevatorAgentWorld::waitingAt(int floor) {
+    return waitingCount[floor >= 1 && floor < (int)waitingCount.size() ? floor : 0];
+}
+
+void ElevatorAgentWorld::withdrawGroup(uint32_t begin, uint32_t count) {
+    for (uint32_t i = begin; i < begin + count; ++i) {
+        sim.Withdraw(order[i], now);
+    }
+}
+
+ElevatorAgentTask ElevatorAgentWorld::passenger(uint32_t begin, uint32_t count) {
+    const ECElevatorSimRequest& req = trace.requests[order[begin]];
+    uint32_t lead = order[begin];   // the group boards and alights together, so one member is watched
+    stats.numPassengers += count;
+    stats.numGroups++;
+    stats.numPresses++;
+    stats.peakAgents = std::max(stats.peakAgents, ++numAlive);
+
+    //a short trip and a queue already at the floor (and no car there now): walk
+    int floors = std::abs(req.GetFloorDest() - req.GetFloorSrc());
+    if (floors > 0 && floors <= agentOptions.stairsMaxFloors && waitingAt(req.GetFloorSrc()) >= agentOptions.stairsMinQueue &&
+        !hasReached(lead, EC_SIM_EV_BOARDED)) {
+        withdrawGroup(begin, count);
+        co_await sleepUntil(now + floors * agentOptions.stepsPerFloorWalking);
+        stats.numTookStairs += count;
+        stats.tripTimeByStairs += (long long)(now - req.GetTime()) * count;
+        numAlive--;
+        co_return;
+    }
+
+    waitingAt(req.GetFloorSrc()) += count;
+    int deadline = agentOptions.patience > 0 ? now + patienceOf(lead) : INT_MAX;
+    while (true) {
+        int wake = deadline;
+        if (agentOptions.repressInterval > 0 && now + agentOptions.repressInterval < wake) {
+            wake = now + agentOptions.repressInterval;
+        }
+        if (co_await waitFor(lead, EC_SIM_EV_BOARDED, wake)) break;
+
+        if (now >= deadline && sim.Withdraw(lead, now)) {
+            //gave up
+            withdrawGroup(begin + 1, count - 1);
+            waitingAt(req.GetFloorSrc()) -= count;
+            stats.numBalked += count;
+            numAlive--;
+            co_return;
+        }
+        if (now >= deadline) {
+            deadline = INT_MAX;   // just boarded, too late to leave
+        }
+        stats.numPresses++;
+    }
+    waitingAt(req.GetFloorSrc()) -= count;
+
+    co_await waitFor(lead, EC_SIM_EV_ALIGHTED, INT_MAX);
+    stats.numArrivedByCar += count;
+    stats.tripTimeByCar += (long long)(now - req.GetTime()) * count;
+    numAlive--;
+}
+
+}
+
+bool IsAgentModelAvailable() {
+    return true;
+}
+
+ElevatorAgentReport RunAgents(const ElevatorTrace& trace, const ElevatorRunOptions& options, const ElevatorAgentOptions& agents) {
+    auto start = std::chrono::steady_clock::now();
+    ElevatorAgentReport report;
+    ElevatorAgentWorld world(trace, options, agents);
+    world.Run();
+    report.run = BuildRunReport(world.GetSim(), options.energy);
+    report.run.strategy = options.strategy;
+    report.run.parking = options.parking;
+    report.agents = world.GetStats();
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+#else
+
+bool IsAgentModelAvailable() {
+    return false;
+}
+
+ElevatorAgentReport RunAgents(const ElevatorTrace& trace, const ElevatorRunOptions& options, const ElevatorAgentOptions&) {
+    auto start = std::chrono::steady_clock::now();
+    ElevatorAgentReport report;
+    report.run = RunHeadless(trace, options);
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+#endif
+
+void PrintAgentReport(std::ostream& out, const ElevatorAgentReport& report) {
+    PrintRunReport(out, report.run);
+    const ElevatorAgentStats& a = report.agents;
+    if (a.numGroups == 0) return;
+
+    out << std::fixed << std::setprecision(2);
+    out << "Agents: " << a.numGroups << " for " << a.numPassengers << " passengers, at most " << a.peakAgents << " at once\n";
+    out << "  by car: " << a.numArrivedByCar;
+    if (a.numArrivedByCar > 0) out << " (trip " << (double)a.tripTimeByCar / a.numArrivedByCar << " on average)";
+    out << ", stairs: " << a.numTookStairs;
+    if (a.numTookStairs > 0) out << " (trip " << (double)a.tripTimeByStairs / a.numTookStairs << " on average)";
+    out << ", gave up: " << a.numBalked << "\n";
+    out << "  button presses: " << a.numPresses << ", resumes: " << a.numResumes << "\n";
+    out << "  frames: up to " << a.maxFrameSize << " bytes, pool " << a.frameBytes / 1024 << " KB\n";
+    out << "Run time: " << report.seconds << " s\n";
+    out.flush();
+}
@@ -0,0 +1,76 @@
+#pragma once
+#ifndef ElevatorAgents_h
+#define ElevatorAgents_h
+
+#include "ECElevatorSim.h"
+#include "ElevatorReport.h"
+#include "ElevatorTraceReader.h"
+#include <iostream>
+
+//*****************************************************************************
+// Passenger agents: every passenger (or group traveling together) of a trace is
+// a C++20 coroutine that decides what to do while it waits. It is suspended on
+// an awaitable (boarded, arrived, or a time) and resumed by the simulator event
+// or the time it waits for:
+// - group travel: passengers making the same call at the same time wait, give
+//   up and ride as one group
+// - stairs: for a short trip, a passenger who finds a queue at the floor walks
+// - re-pressing: the button is pressed again every so often while nothing comes
+// - balking: a passenger who has waited longer than their patience leaves
+// Agents who leave withdraw their request from the simulator (ECElevatorSim::Withdraw).
+//
+// Frames come from a pool (free lists per frame size, carved from large blocks),
+// so spawning and finishing agents doesn't go through the heap; a waiting agent
+// costs its frame plus a few bytes of bookkeeping.
+//
+// Needs a compiler with coroutine support (C++20, e.g. /std:c++20);
+// EC_HAS_AGENT_MODEL tells whether it is compiled in
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define EC_HAS_AGENT_MODEL 1
+#endif
+
+struct ElevatorAgentOptions
+{
+    int patience = 180;            // average steps a passenger waits before leaving (0: never leaves)
+    int repressInterval = 30;      // steps between button presses while waiting
+    int stairsMaxFloors = 2;       // trips this short may take the stairs (0: nobody walks)
+    int stairsMinQueue = 4;        // ... if at least this many are already waiting at the floor
+    int stepsPerFloorWalking = 6;  // time to walk one floor
+    bool groupTravel = true;       // same call at the same time: one group
+    int maxGroupSize = 6;
+};
+
+struct ElevatorAgentStats
+{
+    long long numPassengers = 0;
+    long long numGroups = 0;          // agents (a group is one agent)
+    long long numArrivedByCar = 0;
+    long long numTookStairs = 0;
+    long long numBalked = 0;
+    long long numPresses = 0;         // including the first one
+    long long tripTimeByCar = 0;      // request to arrival, summed
+    long long tripTimeByStairs = 0;
+    long long peakAgents = 0;         // agents alive at once
+    long long numResumes = 0;
+    size_t frameBytes = 0;            // memory the frame pool holds at the end
+    size_t maxFrameSize = 0;
+};
+
+struct ElevatorAgentReport
+{
+    ElevatorRunReport run;
+    ElevatorAgentStats agents;
+    double seconds = 0.0;
+};
+
+// True if the agent model is compiled in
+bool IsAgentModelAvailable();
+
+// Run the trace with a passenger agent per request (or group); without coroutine
+// support only the plain run is done
+ElevatorAgentReport RunAgents(const ElevatorTrace& trace, const ElevatorRunOptions& options, const ElevatorAgentOptions& agents);
+
+void PrintAgentReport(std::ostream& out, const ElevatorAgentReport& report);
+
+#endif
@@ -0,0 +1,215 @@
+#include "ElevatorAnalytics.h"
+#include <algorithm>
+#include <iomanip>
+
+// ElevatorAnalytics Implementation
+ElevatorAnalytics::ElevatorAnalytics()
+    : numFloors(1), lenSim(1), numColumns(1), numRows(1), binWidth(1), floorsPerRow(1),
+      numEvents(0), numPassengers(0), numBoarded(0), peakWaiting(0) {
+}
+
+void ElevatorAnalytics::Begin(int numFloorsIn, int lenSimIn, const ElevatorAnalyticsOptions& options) {
+    numFloors = std::max(1, numFloorsIn);
+    lenSim = std::max(1, lenSimIn);
+
+    //equal bins, as many as allowed (the last one may be shorter)
+    int maxColumns = std::max(1, options.maxColumns);
+    binWidth = (lenSim + maxColumns - 1) / maxColumns;
+    numColumns = (lenSim + binWidth - 1) / binWidth;
+    int maxRows = std::max(1, options.maxRows);
+    floorsPerRow = (numFloors + maxRows - 1) / maxRows;
+    numRows = (numFloors + floorsPerRow - 1) / floorsPerRow;
+
+    cells.assign((size_t)numRows * numColumns, ElevatorAnalyticsCell());
+    cars.assign(1, std::vector<ElevatorAnalyticsCarColumn>(numColumns));
+    carStates.assign(1, CarState());
+    waitingCount.assign(numFloors + 1, 0);
+    waitingSince.assign(numFloors + 1, 0);
+    waitingRequests.clear();
+
+    numEvents = 0;
+    numPassengers = 0;
+    numBoarded = 0;
+    peakWaiting = 0;
+}
+
+int ElevatorAnalytics::columnOf(int time) const {
+    return std::min(std::max(time, 0) / binWidth, numColumns - 1);
+}
+
+// accumulateQueue helper method, adds the passengers waiting at floor since the last change up to time
+void ElevatorAnalytics::accumulateQueue(int floor, int time) {
+    int count = waitingCount[floor];
+    int from = std::min(waitingSince[floor], lenSim);
+    int to = std::min(std::max(time, from), lenSim);
+    waitingSince[floor] = std::max(waitingSince[floor], time);
+    if (count == 0 || from >= to) return;
+
+    int row = rowOf(floor);
+    while (from < to) {
+        int col = columnOf(from);
+        int end = std::min(to, (col + 1) * binWidth);
+        cells[(size_t)row * numColumns + col].queueArea += (double)count * (end - from);
+        from = end;
+    }
+}
+
+// carColumn helper method, fills the columns the car stayed put in, up to col
+ElevatorAnalyticsCarColumn& ElevatorAnalytics::carColumn(int car, int col) {
+    CarState& state = carStates[car];
+    while (state.numColumns <= col) {
+        ElevatorAnalyticsCarColumn& column = cars[car][state.numColumns++];
+        column.floorMin = column.floorMax = column.floorLast = state.floor;
+        column.inMaintenance = state.inMaintenance;
+    }
+    return cars[car][col];
+}
+
+void ElevatorAnalytics::Add(const ElevatorEventRecord& rec) {
+    numEvents++;
+    int car = rec.car;
+    if (car >= (int)carStates.size()) {
+        carStates.resize(car + 1);
+        cars.resize(car + 1, std::vector<ElevatorAnalyticsCarColumn>(numColumns));
+    }
+    int col = columnOf(rec.time);
+
+    switch (rec.type) {
+    case EC_SIM_EV_REQUEST_ARRIVED:
+        numPassengers++;
+        //passengers outside the building are never picked up
+        if (inBuilding(rec.floor)) {
+            accumulateQueue(rec.floor, rec.time);
+            waitingCount[rec.floor]++;
+            waitingRequests[rec.request] = rec.time;
+            peakWaiting = std::max(peakWaiting, waitingRequests.size());
+        }
+        break;
+    case EC_SIM_EV_BOARDED: {
+        auto it = waitingRequests.find(rec.request);
+        if (it == waitingRequests.end() || !inBuilding(rec.floor)) break;
+
+        accumulateQueue(rec.floor, rec.time);
+        waitingCount[rec.floor] = std::max(0, waitingCount[rec.floor] - 1);
+        int wait = rec.time - it->second;
+        waitingRequests.erase(it);
+        numBoarded++;
+
+        ElevatorAnalyticsCell& cell = cells[(size_t)rowOf(rec.floor) * numColumns + col];
+        cell.waitSum += wait;
+        cell.waitCount++;
+        cell.waitMax = std::max(cell.waitMax, wait);
+        break;
+    }
+    case EC_SIM_EV_WITHDRAWN: {
+        //gave up: leaves the queue without a wait to count
+        auto it = waitingRequests.find(rec.request);
+        if (it == waitingRequests.end() || !inBuilding(rec.floor)) break;
+
+        accumulateQueue(rec.floor, rec.time);
+        waitingCount[rec.floor] = std::max(0, waitingCount[rec.floor] - 1);
+        waitingRequests.erase(it);
+        break;
+    }
+    case EC_SIM_EV_CAR_MOVED: {
+        ElevatorAnalyticsCarColumn& column = carColumn(car, col);
+        carStates[car].floor = rec.floor;
+        column.floorMin = std::min(column.floorMin, (int)rec.floor);
+        column.floorMax = std::max(column.floorMax, (int)rec.floor);
+        column.floorLast = rec.floor;
+        break;
+    }
+    case EC_SIM_EV_MAINTENANCE_START:
+    case EC_SIM_EV_MAINTENANCE_END:
+        //a bin with any time out of service is marked
+        carColumn(car, col).inMaintenance = true;
+        carStates[car].inMaintenance = rec.type == EC_SIM_EV_MAINTENANCE_START;
+        break;
+    }
+}
+
+void ElevatorAnalytics::Finish() {
+    for (int floor = 1; floor <= numFloors; ++floor) {
+        accumulateQueue(floor, lenSim);
+    }
+    for (int car = 0; car < (int)cars.size(); ++car) {
+        carColumn(car, numColumns - 1);
+    }
+}
+
+double ElevatorAnalytics::GetAverageQueue(int row, int col) const {
+    int begin = col * binWidth;
+    int length = std::min(lenSim, begin + binWidth) - begin;
+    return length > 0 ? GetCell(row, col).queueArea / length : 0.0;
+}
+
+double ElevatorAnalytics::GetAverageWait(int row, int col) const {
+    const ElevatorAnalyticsCell& cell = GetCell(row, col);
+    return cell.waitCount > 0 ? cell.waitSum / cell.waitCount : 0.0;
+}
+
+bool AnalyzeEventLog(const std::string& path, const ElevatorAnalyticsOptions& options, ElevatorAnalytics& analytics, std::string& error) {
+    ElevatorEventLogReader reader;
+    if (!reader.Open(path)) {
+        error = "not an event log: " + path;
+        return false;
+    }
+    analytics.Begin(reader.GetHeader().numFloors, reader.GetHeader().lenSim, options);
+    ElevatorEventRecord rec;
+    while (reader.Next(rec)) {
+        analytics.Add(rec);
+    }
+    analytics.Finish();
+    return true;
+}
+
+// floor band of a row, e.g. "12" or "12-15"
+static std::string FloorsOfRow(const ElevatorAnalytics& analytics, int row) {
+    int first = row * analytics.GetFloorsPerRow() + 1;
+    int last = std::min(analytics.GetNumFloors(), first + analytics.GetFloorsPerRow() - 1);
+    return first == last ? std::to_string(first) : std::to_string(first) + "-" + std::to_string(last);
+}
+
+void PrintAnalyticsReport(std::ostream& out, const ElevatorAnalytics& analytics) {
+    out << "Events: " << analytics.GetNumEvents() << ", passengers: " << analytics.GetNumPassengers()
+        << " (" << analytics.GetNumBoarded() << " boarded), at most " << analytics.GetPeakWaiting() << " waiting at once\n";
+    out << "Grid: " << analytics.GetNumRows() << " floor band(s) of " << analytics.GetFloorsPerRow() << " x "
+        << analytics.GetNumColumns() << " time bin(s) of " << analytics.GetBinWidth() << "\n";
+
+    //the cells with the longest queues
+    struct Hotspot
+    {
+        int row;
+        int col;
+        double queue;
+    };
+    std::vector<Hotspot> hotspots;
+    for (int row = 0; row < analytics.GetNumRows(); ++row) {
+        for (int col = 0; col < analytics.GetNumColumns(); ++col) {
+            double queue = analytics.GetAverageQueue(row, col);
+            if (queue > 0.0) {
+                hotspots.push_back(Hotspot{ row, col, queue });
+            }
+        }
+    }
+    size_t numShown = std::min<size_t>(10, hotspots.size());
+    std::partial_sort(hotspots.begin(), hotspots.begin() + numShown, hotspots.end(), [](const Hotspot& a, const Hotspot& b) {
+        return a.queue != b.queue ? a.queue > b.queue : (a.col != b.col ? a.col < b.col : a.row < b.row);
+    });
+
+    out << "Longest queues:\n";
+    out << std::left << std::setw(10) << "Floors" << std::setw(14) << "Time"
+        << std::right << std::setw(10) << "Queue" << std::setw(10) << "Boarded" << std::setw(10) << "Avg wait" << std::setw(10) << "Max wait" << "\n";
+    for (size_t i = 0; i < numShown; ++i) {
+        const Hotspot& h = hotspots[i];
+        const ElevatorAnalyticsCell& cell = analytics.GetCell(h.row, h.col);
+        int begin = h.col * analytics.GetBinWidth();
+        int end = std::min(analytics.GetLenSim(), begin + analytics.GetBinWidth());
+        out << std::left << std::setw(10) << FloorsOfRow(analytics, h.row)
+            << std::setw(14) << (std::to_string(begin) + "-" + std::to_string(end))
+            << std::right << std::setw(10) << std::fixed << std::setprecision(2) << h.queue
+            << std::setw(10) << cell.waitCount << std::setw(10) << analytics.GetAverageWait(h.row, h.col)
+            << std::setw(10) << cell.waitMax << "\n";
+    }
+    out.flush();
+}
@@ -0,0 +1,117 @@
+#pragma once
+#ifndef ElevatorAnalytics_h
+#define ElevatorAnalytics_h
+
+#include "ElevatorEventLog.h"
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//*****************************************************************************
+// Where and when a run was congested, built from its events in one streaming
+// pass. Time is cut into at most maxColumns equal bins and floors into at most
+// maxRows bands, so the grids have a fixed size whatever the length of the run;
+// besides them only the passengers waiting at the moment are kept. Events must
+// come in time order (as the simulator makes them and the event log stores them)
+//
+// Per cell (floor band x time bin):
+// - queue: average number of passengers waiting at those floors (together) during the bin
+// - wait: average / longest wait of the passengers who boarded there in the bin
+// Per car and time bin: lowest, highest and last floor, for a space-time diagram
+
+struct ElevatorAnalyticsOptions
+{
+    int maxColumns = 900;
+    int maxRows = 120;
+};
+
+struct ElevatorAnalyticsCell
+{
+    double queueArea = 0.0;    // sum of (waiting passengers x time)
+    double waitSum = 0.0;
+    int waitCount = 0;
+    int waitMax = 0;
+};
+
+struct ElevatorAnalyticsCarColumn
+{
+    int floorMin = 1;          // lowest / highest floor the car was at during the bin
+    int floorMax = 1;
+    int floorLast = 1;         // where the car is at the end of the bin
+    bool inMaintenance = false;
+};
+
+class ElevatorAnalytics
+{
+public:
+    ElevatorAnalytics();
+
+    void Begin(int numFloors, int lenSim, const ElevatorAnalyticsOptions& options = ElevatorAnalyticsOptions());
+    void Add(const ElevatorEventRecord& rec);
+    void Finish();
+
+    int GetNumFloors() const { return numFloors; }
+    int GetLenSim() const { return lenSim; }
+    int GetNumColumns() const { return numColumns; }
+    int GetNumRows() const { return numRows; }
+    int GetBinWidth() const { return binWidth; }        // time units per column
+    int GetFloorsPerRow() const { return floorsPerRow; }
+
+    // row 0 holds floor 1 (and the next floorsPerRow - 1 floors)
+    const ElevatorAnalyticsCell& GetCell(int row, int col) const { return cells[(size_t)row * numColumns + col]; }
+    double GetAverageQueue(int row, int col) const;
+    double GetAverageWait(int row, int col) const;
+
+    int GetNumCars() const { return (int)cars.size(); }
+    const ElevatorAnalyticsCarColumn& GetCarColumn(int car, int col) const { return cars[car][col]; }
+
+    uint64_t GetNumEvents() const { return numEvents; }
+    int GetNumPassengers() const { return numPassengers; }
+    int GetNumBoarded() const { return numBoarded; }
+    size_t GetPeakWaiting() const { return peakWaiting; }   // largest number of waiting passengers kept at once
+
+private:
+    struct CarState
+    {
+        int floor = 1;
+        bool inMaintenance = false;
+        int numColumns = 0;   // columns filled in so far
+    };
+
+    int columnOf(int time) const;
+    int rowOf(int floor) const { return (floor - 1) / floorsPerRow; }
+    bool inBuilding(int floor) const { return floor >= 1 && floor <= numFloors; }
+    void accumulateQueue(int floor, int time);
+    ElevatorAnalyticsCarColumn& carColumn(int car, int col);
+
+    int numFloors;
+    int lenSim;
+    int numColumns;
+    int numRows;
+    int binWidth;
+    int floorsPerRow;
+    std::vector<ElevatorAnalyticsCell> cells;                      // numRows x numColumns
+    std::vector<std::vector<ElevatorAnalyticsCarColumn>> cars;    // per car, numColumns
+    std::vector<CarState> carStates;
+
+    // waiting passengers: per floor how many and since when the count is unchanged,
+    // per request when it was made (dropped once it boards)
+    std::vector<int> waitingCount;
+    std::vector<int> waitingSince;
+    std::unordered_map<uint32_t, int32_t> waitingRequests;
+
+    uint64_t numEvents;
+    int numPassengers;
+    int numBoarded;
+    size_t peakWaiting;
+};
+
+// One pass over an event log file
+bool AnalyzeEventLog(const std::string& path, const ElevatorAnalyticsOptions& options, ElevatorAnalytics& analytics, std::string& error);
+
+// Busiest floors and times, as text
+void PrintAnalyticsReport(std::ostream& out, const ElevatorAnalytics& analytics);
+
+#endif
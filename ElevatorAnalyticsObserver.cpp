@@ -0,0 +1,143 @@
+#include "ElevatorAnalyticsObserver.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+	const int PLOT_W = 900;     //width of the panels, a whole number of pixels per time bin
+	const int LEFT_MARGIN = 70;  //room for the floor labels
+	const int RIGHT_MARGIN = 20;
+	const int TITLE_H = 30;
+	const int PANEL_H = 250;
+	const int BOTTOM_MARGIN = 30;   //room for the time labels
+	const int NUM_PANELS = 3;
+	const ECGVColor CAR_COLORS[] = { ECGV_BLUE, ECGV_RED, ECGV_GREEN, ECGV_PURPLE, ECGV_CYAN };
+
+	//white (none) over yellow and red to dark purple (the most)
+	void HeatColor(double v, unsigned char& r, unsigned char& g, unsigned char& b) {
+		static const double stops[][3] = { { 255, 245, 200 }, { 255, 210, 0 }, { 220, 40, 0 }, { 90, 0, 70 } };
+		v = std::min(1.0, std::max(0.0, v)) * 3.0;
+		int i = std::min(2, (int)v);
+		double f = v - i;
+		r = (unsigned char)(stops[i][0] + (stops[i + 1][0] - stops[i][0]) * f);
+		g = (unsigned char)(stops[i][1] + (stops[i + 1][1] - stops[i][1]) * f);
+		b = (unsigned char)(stops[i][2] + (stops[i + 1][2] - stops[i][2]) * f);
+	}
+}
+
+ElevatorAnalyticsObserver::ElevatorAnalyticsObserver(ECGraphicViewImp& displayManager, const ElevatorAnalytics& analytics) : displayManager(displayManager),
+	analyticsRef(analytics),
+	columnWidth(std::max(1, PLOT_W / analytics.GetNumColumns())),
+	maxQueue(0.0),
+	maxWait(0.0)
+	{
+		for (int row = 0; row < analytics.GetNumRows(); row++) {
+			for (int col = 0; col < analytics.GetNumColumns(); col++) {
+				maxQueue = std::max(maxQueue, analytics.GetAverageQueue(row, col));
+				maxWait = std::max(maxWait, analytics.GetAverageWait(row, col));
+			}
+		}
+	}
+
+void ElevatorAnalyticsObserver::GetViewSize(const ElevatorAnalytics& analytics, int& width, int& height) {
+	int columnWidth = std::max(1, PLOT_W / analytics.GetNumColumns());
+	width = LEFT_MARGIN + columnWidth * analytics.GetNumColumns() + RIGHT_MARGIN;
+	height = NUM_PANELS * (TITLE_H + PANEL_H) + BOTTOM_MARGIN;
+}
+
+void ElevatorAnalyticsObserver::Update() {
+	if (displayManager.GetCurrEvent() != ECGV_EV_TIMER) return;
+
+	char title[128];
+	snprintf(title, sizeof(title), "Waiting passengers (up to %.2f on average)", maxQueue);
+	RenderHeatmap(0, false);
+	RenderAxes(0, title);
+	snprintf(title, sizeof(title), "Wait time of the passengers boarding (up to %.1f on average)", maxWait);
+	RenderHeatmap(1, true);
+	RenderAxes(1, title);
+	RenderSpaceTime(2);
+	RenderAxes(2, "Floor of the car(s)");
+	displayManager.SetRedraw(true);
+}
+
+int ElevatorAnalyticsObserver::PanelTop(int panel) const {
+	return panel * (TITLE_H + PANEL_H) + TITLE_H;
+}
+
+int ElevatorAnalyticsObserver::ColumnX(int col) const {
+	return LEFT_MARGIN + col * columnWidth;
+}
+
+void ElevatorAnalyticsObserver::RenderHeatmap(int panel, bool wait) {
+	int top = PanelTop(panel);
+	int numRows = analyticsRef.GetNumRows();
+	double scale = wait ? maxWait : maxQueue;
+	if (scale <= 0.0) return;
+
+	//one rectangle per cell, row 0 (the lowest floors) at the bottom
+	for (int row = 0; row < numRows; row++) {
+		int y1 = top + PANEL_H - (row + 1) * PANEL_H / numRows;
+		int y2 = top + PANEL_H - row * PANEL_H / numRows;
+		for (int col = 0; col < analyticsRef.GetNumColumns(); col++) {
+			double value = wait ? analyticsRef.GetAverageWait(row, col) : analyticsRef.GetAverageQueue(row, col);
+			if (value <= 0.0) continue;
+			unsigned char r, g, b;
+			HeatColor(value / scale, r, g, b);
+			displayManager.DrawFilledRectangleRGB(ColumnX(col), y1, ColumnX(col + 1), y2, r, g, b);
+		}
+	}
+}
+
+void ElevatorAnalyticsObserver::RenderSpaceTime(int panel) {
+	int top = PanelTop(panel);
+	int numFloors = analyticsRef.GetNumFloors();
+	auto floorY = [&](int floor) { return top + PANEL_H - (int)((floor - 0.5) * PANEL_H / numFloors); };
+
+	//out of service first, under the cars
+	for (int car = 0; car < analyticsRef.GetNumCars(); car++) {
+		for (int col = 0; col < analyticsRef.GetNumColumns(); col++) {
+			if (analyticsRef.GetCarColumn(car, col).inMaintenance) {
+				displayManager.DrawFilledRectangleRGB(ColumnX(col), top, ColumnX(col + 1), top + PANEL_H, 225, 225, 225);
+			}
+		}
+	}
+
+	//every bin spans the floors the car was at, so the columns join up into the path of the car
+	for (int car = 0; car < analyticsRef.GetNumCars(); car++) {
+		ECGVColor color = CAR_COLORS[car % (sizeof(CAR_COLORS) / sizeof(CAR_COLORS[0]))];
+		for (int col = 0; col < analyticsRef.GetNumColumns(); col++) {
+			const ElevatorAnalyticsCarColumn& column = analyticsRef.GetCarColumn(car, col);
+			displayManager.DrawFilledRectangle(ColumnX(col), floorY(column.floorMax) - 1, ColumnX(col + 1), floorY(column.floorMin) + 1, color);
+		}
+	}
+}
+
+void ElevatorAnalyticsObserver::RenderAxes(int panel, const std::string& title) {
+	int top = PanelTop(panel);
+	int right = ColumnX(analyticsRef.GetNumColumns());
+	int middle = (LEFT_MARGIN + right) / 2;
+	displayManager.DrawText(middle, top - TITLE_H + 8, title.c_str(), ECGV_BLACK);
+	displayManager.DrawRectangle(LEFT_MARGIN, top, right, top + PANEL_H, 1, ECGV_BLACK);
+
+	//floors on the left, time under the last panel
+	std::string lowest = "floor 1";
+	std::string highest = "floor " + std::to_string(analyticsRef.GetNumFloors());
+	displayManager.DrawText(LEFT_MARGIN / 2, top + PANEL_H - 12, lowest.c_str(), ECGV_BLACK);
+	displayManager.DrawText(LEFT_MARGIN / 2, top + 2, highest.c_str(), ECGV_BLACK);
+	if (panel == NUM_PANELS - 1) {
+		int y = top + PANEL_H + 8;
+		std::string end = std::to_string(analyticsRef.GetLenSim());
+		std::string half = std::to_string(analyticsRef.GetLenSim() / 2);
+		displayManager.DrawText(LEFT_MARGIN, y, "0", ECGV_BLACK);
+		displayManager.DrawText(middle, y, ("time " + half).c_str(), ECGV_BLACK);
+		displayManager.DrawText(right - 10, y, end.c_str(), ECGV_BLACK);
+	}
+}
+
+bool RenderAnalytics(const ElevatorAnalytics& analytics, const std::string& path) {
+	int width, height;
+	ElevatorAnalyticsObserver::GetViewSize(analytics, width, height);
+	ECGraphicViewImp view(width, height, true);
+	ElevatorAnalyticsObserver obs(view, analytics);
+	view.Attach(&obs);
+	return view.RenderFrame() && view.SaveFrame(path);
+}
@@ -0,0 +1,40 @@
+#pragma once
+#ifndef ElevatorAnalyticsObserver_h
+#define ElevatorAnalyticsObserver_h
+
+#include "ECObserver.h"
+#include "ECGraphicViewImp.h"
+#include "ElevatorAnalytics.h"
+#include <string>
+
+//Draws the analytics of a finished run, three panels sharing the time axis:
+//  queue length per floor and time, wait time per floor and time (both as heatmaps),
+//  and the floor of every car over time (a space-time diagram; out of service shaded)
+class ElevatorAnalyticsObserver : public ECObserver {
+public:
+	ElevatorAnalyticsObserver(ECGraphicViewImp& displayManager, const ElevatorAnalytics& analytics);
+	virtual void Update();
+	virtual ECEventMask GetEventMask() const { return ECGV_MASK_TIMER; }
+
+	//size of a view that fits the panels
+	static void GetViewSize(const ElevatorAnalytics& analytics, int& width, int& height);
+
+private:
+	ECGraphicViewImp& displayManager;
+	const ElevatorAnalytics& analyticsRef;
+
+	int columnWidth;   //pixels per time bin
+	double maxQueue;   //top of the color scales
+	double maxWait;
+
+	int PanelTop(int panel) const;
+	int ColumnX(int col) const;
+	void RenderHeatmap(int panel, bool wait);
+	void RenderSpaceTime(int panel);
+	void RenderAxes(int panel, const std::string& title);
+};
+
+//Draws the analytics offscreen and saves them as one image (the format follows the extension, e.g. .png)
+bool RenderAnalytics(const ElevatorAnalytics& analytics, const std::string& path);
+
+#endif
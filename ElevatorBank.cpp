@@ -0,0 +1,348 @@
+#include "ElevatorBank.h"
+#include "ElevatorHallCalls.h"
+#include "ElevatorRequestPool.h"
+#include "ElevatorStrategyRegistry.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+// Steps a stop costs (the car stands for one step to load/unload)
+static const double STOP_STEPS = 1.0;
+// Share of the passengers of a car delayed by one extra stop (not all of them pass it)
+static const double STOP_DELAY_SHARE = 0.5;
+
+static bool IsMaintenance(const ECElevatorSimRequest& req) {
+    return req.IsMaintenanceStart() || req.IsMaintenanceEnd();
+}
+
+// StopsBetween helper function, planned stops strictly between floors a and b
+static int StopsBetween(const ElevatorFloorSet& stops, int a, int b) {
+    if (a > b) std::swap(a, b);
+    int count = 0;
+    for (int f = stops.NextAbove(a); f != -1 && f < b; f = stops.NextAbove(f)) {
+        count++;
+    }
+    return count;
+}
+
+// ElevatorBank Implementation
+ElevatorBank::ElevatorBank(int numFloorsIn, const ElevatorBankOptions& optionsIn)
+    : numFloors(numFloorsIn), options(optionsIn), totalDecisionUs(0.0), maxDecisionUs(0.0), numDecisions(0) {
+    int numCars = std::max(1, options.numCars);
+    for (int c = 0; c < numCars; ++c) {
+        ECElevatorSim* car = new ECElevatorSim(numFloors, std::vector<ECElevatorSimRequest>(),
+            ElevatorStrategyRegistry::Instance().Create(options.strategy));
+        cars.push_back(car);
+    }
+    outOfService.assign(numCars, false);
+}
+
+ElevatorBank::~ElevatorBank() {
+    for (ECElevatorSim* car : cars) {
+        delete car;
+    }
+}
+
+void ElevatorBank::Simulate(int time) {
+    for (ECElevatorSim* car : cars) {
+        car->Simulate(time);
+    }
+}
+
+ElevatorBank::CarPlan ElevatorBank::planOf(int car) const {
+    CarPlan plan;
+    plan.stops = cars[car]->GetFloorDemand().GetAll();
+    plan.numPassengers = cars[car]->GetLiveStats().numWaiting + cars[car]->GetLiveStats().numRiding;
+    return plan;
+}
+
+// estimateArrival: steps until the car picks up at floorSrc, following its current
+// sweep (collective rules: a call is picked up when the car passes it going its way)
+double ElevatorBank::estimateArrival(int car, const CarPlan& plan, int floorSrc, bool up) const {
+    int pos = cars[car]->GetCurrFloor();
+    EC_ELEVATOR_DIR dir = cars[car]->GetCurrDir();
+    if (dir == EC_ELEVATOR_STOPPED) {
+        if (pos == floorSrc) return 0.0;
+        dir = (floorSrc > pos) ? EC_ELEVATOR_UP : EC_ELEVATOR_DOWN;
+    }
+
+    const ElevatorFloorSet& stops = plan.stops;
+    double steps = 0.0;
+    for (int leg = 0; leg < 3; ++leg) {
+        if (dir == EC_ELEVATOR_UP) {
+            if (up && floorSrc >= pos) {
+                return steps + (floorSrc - pos) + STOP_STEPS * StopsBetween(stops, pos, floorSrc);
+            }
+            //to the top of the sweep, then back down
+            int top = std::max(pos, stops.NextBelow(numFloors + 1));
+            if (!up) top = std::max(top, floorSrc);
+            steps += (top - pos) + STOP_STEPS * StopsBetween(stops, pos, top + 1);
+            pos = top;
+            dir = EC_ELEVATOR_DOWN;
+        }
+        else {
+            if (!up && floorSrc <= pos) {
+                return steps + (pos - floorSrc) + STOP_STEPS * StopsBetween(stops, floorSrc, pos);
+            }
+            int bottom = pos;
+            int lowest = stops.NextAbove(0);
+            if (lowest != -1) bottom = std::min(bottom, lowest);
+            if (up) bottom = std::min(bottom, floorSrc);
+            steps += (pos - bottom) + STOP_STEPS * StopsBetween(stops, bottom - 1, pos);
+            pos = bottom;
+            dir = EC_ELEVATOR_UP;
+        }
+    }
+    return steps;
+}
+
+// estimateCost: wait + ride of the new passenger, plus the delay its extra stops
+// cause everyone else in the car
+double ElevatorBank::estimateCost(int car, const CarPlan& plan, const ECElevatorSimRequest& call) const {
+    int src = call.GetFloorSrc(), dest = call.GetFloorDest();
+    double wait = estimateArrival(car, plan, src, dest > src);
+    double ride = std::abs(dest - src) + STOP_STEPS * StopsBetween(plan.stops, src, dest);
+    int newStops = (inBuilding(src) && plan.stops.Test(src) ? 0 : 1) + (inBuilding(dest) && plan.stops.Test(dest) ? 0 : 1);
+    return wait + ride + STOP_DELAY_SHARE * STOP_STEPS * plan.numPassengers * newStops;
+}
+
+// assignCollective: the hall call goes to the car that already has it, else to the
+// car that gets there first (fewer passengers on a tie)
+int ElevatorBank::assignCollective(const ECElevatorSimRequest& call) {
+    int src = call.GetFloorSrc();
+    bool up = call.GetFloorDest() > src;
+
+    int best = -1;
+    double bestEta = 0.0;
+    for (int c = 0; c < (int)cars.size(); ++c) {
+        if (!isAvailable(c)) continue;
+        if (!cars[c]->GetHallCalls().GetWaiting(src, up).empty()) {
+            return c;
+        }
+        CarPlan plan = planOf(c);
+        double eta = estimateArrival(c, plan, src, up);
+        if (best == -1 || eta < bestEta ||
+            (eta == bestEta && plan.numPassengers < planOf(best).numPassengers)) {
+            best = c;
+            bestEta = eta;
+        }
+    }
+    return best == -1 ? 0 : best;
+}
+
+// assignDestination: greedy placement of the batch, then single moves between
+// cars while they lower the total cost and the time budget lasts. The car plans
+// follow every placement and move (a stop stays while anything needs it); once the
+// budget is spent, the remaining calls go to the car that picks them up soonest
+std::vector<int> ElevatorBank::assignDestination(const std::vector<ECElevatorSimRequest>& calls) {
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::micro>(options.budgetUs * calls.size()));
+
+    int numCars = (int)cars.size();
+    std::vector<CarPlan> plans(numCars);
+    std::vector<std::vector<int>> stopUses(numCars, std::vector<int>(numFloors + 1, 0));
+    for (int c = 0; c < numCars; ++c) {
+        plans[c] = planOf(c);
+        for (int f = 1; f <= numFloors; ++f) {
+            if (plans[c].stops.Test(f)) stopUses[c][f] = 1;
+        }
+    }
+
+    //add (delta 1) or take out (delta -1) call i from the plan of car
+    auto place = [&](size_t i, int car, int delta) {
+        for (int floor : { calls[i].GetFloorSrc(), calls[i].GetFloorDest() }) {
+            if (!inBuilding(floor)) continue;
+            int& uses = stopUses[car][floor];
+            uses += delta;
+            if (uses > 0) plans[car].stops.Set(floor);
+            else plans[car].stops.Clear(floor);
+        }
+        plans[car].numPassengers += delta;
+    };
+    //cost of call i in car, which doesn't have it in its plan
+    auto costIn = [&](size_t i, int car) { return estimateCost(car, plans[car], calls[i]); };
+    //cost of every call given to car
+    std::vector<int> assigned(calls.size(), -1);
+    auto carCost = [&](int car) {
+        double cost = 0.0;
+        for (size_t j = 0; j < calls.size(); ++j) {
+            if (assigned[j] != car) continue;
+            place(j, car, -1);
+            cost += costIn(j, car);
+            place(j, car, 1);
+        }
+        return cost;
+    };
+
+    for (size_t i = 0; i < calls.size(); ++i) {
+        bool inBudget = std::chrono::steady_clock::now() < deadline;
+        bool up = calls[i].GetFloorDest() > calls[i].GetFloorSrc();
+        int best = -1;
+        double bestCost = 0.0;
+        for (int c = 0; c < numCars; ++c) {
+            if (!isAvailable(c)) continue;
+            double cost = inBudget ? costIn(i, c) : estimateArrival(c, plans[c], calls[i].GetFloorSrc(), up);
+            if (best == -1 || cost < bestCost) {
+                best = c;
+                bestCost = cost;
+            }
+        }
+        assigned[i] = best == -1 ? 0 : best;
+        place(i, assigned[i], 1);
+    }
+
+    //a move is only tried if one as long as the previous still fits in the budget
+    std::chrono::steady_clock::duration moveTime(0);
+    bool improved = calls.size() > 1;
+    while (improved) {
+        improved = false;
+        for (size_t i = 0; i < calls.size(); ++i) {
+            int from = assigned[i];
+            for (int c = 0; c < numCars; ++c) {
+                if (c == from || !isAvailable(c)) continue;
+                auto moveStart = std::chrono::steady_clock::now();
+                if (moveStart + moveTime >= deadline) return assigned;
+                double before = carCost(from) + carCost(c);
+                place(i, from, -1);
+                place(i, c, 1);
+                assigned[i] = c;
+                double after = carCost(from) + carCost(c);
+                if (after < before - 1e-9) {
+                    from = c;
+                    improved = true;
+                }
+                else {
+                    place(i, c, -1);
+                    place(i, from, 1);
+                    assigned[i] = from;
+                }
+                moveTime = std::chrono::steady_clock::now() - moveStart;
+            }
+        }
+    }
+    return assigned;
+}
+
+std::vector<int> ElevatorBank::Call(const std::vector<ECElevatorSimRequest>& calls, int time) {
+    (void)time;
+    std::vector<int> result(calls.size(), -1);
+
+    //maintenance first, so a car taken out of service this step gets no new passengers
+    std::vector<ECElevatorSimRequest> passengers;
+    std::vector<size_t> passengerIndex;
+    for (size_t i = 0; i < calls.size(); ++i) {
+        if (IsMaintenance(calls[i])) {
+            outOfService[0] = calls[i].IsMaintenanceStart();
+            cars[0]->AddRequest(calls[i]);
+        }
+        else {
+            passengers.push_back(calls[i]);
+            passengerIndex.push_back(i);
+        }
+    }
+    if (passengers.empty()) return result;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<int> assigned;
+    if (options.dispatch == "collective") {
+        for (const auto& call : passengers) {
+            int car = assignCollective(call);
+            assigned.push_back(car);
+            cars[car]->AddRequest(call);
+        }
+    }
+    else {
+        assigned = assignDestination(passengers);
+        for (size_t i = 0; i < passengers.size(); ++i) {
+            cars[assigned[i]]->AddRequest(passengers[i]);
+        }
+    }
+
+    double perCallUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / passengers.size();
+    totalDecisionUs += perCallUs * passengers.size();
+    maxDecisionUs = std::max(maxDecisionUs, perCallUs);
+    numDecisions += passengers.size();
+
+    for (size_t i = 0; i < passengers.size(); ++i) {
+        result[passengerIndex[i]] = assigned[i];
+    }
+    return result;
+}
+
+ElevatorBankReport RunBank(const ElevatorTrace& trace, const ElevatorBankOptions& options, const ElevatorEnergyModel& energy) {
+    ElevatorBank bank(trace.numFloors, options);
+    ElevatorBankReport report;
+    report.dispatch = options.dispatch;
+    report.numAssigned.assign(bank.GetNumCars(), 0);
+
+    //calls in the order they are made (list order within a step)
+    std::vector<size_t> order(trace.requests.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&trace](size_t a, size_t b) {
+        return trace.requests[a].GetTime() < trace.requests[b].GetTime();
+    });
+
+    size_t next = 0;
+    std::vector<ECElevatorSimRequest> calls;
+    for (int t = 0; t < trace.lenSim; ++t) {
+        calls.clear();
+        while (next < order.size() && trace.requests[order[next]].GetTime() <= t) {
+            calls.push_back(trace.requests[order[next++]]);
+        }
+        if (!calls.empty()) {
+            std::vector<int> assigned = bank.Call(calls, t);
+            for (size_t i = 0; i < calls.size(); ++i) {
+                if (assigned[i] >= 0) report.numAssigned[assigned[i]]++;
+            }
+        }
+        bank.Simulate(t);
+    }
+
+    std::vector<ElevatorWaitSummary> waits;
+    for (int c = 0; c < bank.GetNumCars(); ++c) {
+        report.cars.push_back(BuildRunReport(bank.GetCar(c), energy));
+        waits.push_back(bank.GetCar(c).GetWaitSummary());
+    }
+    report.total = MergeRunReports(report.cars, waits, energy);
+    report.total.strategy = options.dispatch + " dispatch, " + std::to_string(bank.GetNumCars()) + " cars, car policy " + options.strategy;
+    report.avgDecisionUs = bank.GetAverageDecisionUs();
+    report.maxDecisionUs = bank.GetMaxDecisionUs();
+    return report;
+}
+
+void PrintBankReport(std::ostream& out, const ElevatorBankReport& report) {
+    out << std::left << std::setw(6) << "Car"
+        << std::right << std::setw(12) << "Passengers" << std::setw(10) << "Avg wait"
+        << std::setw(10) << "p99 wait" << std::setw(8) << "Floors" << std::setw(8) << "Stops" << "\n";
+    for (size_t c = 0; c < report.cars.size(); ++c) {
+        const ElevatorRunReport& r = report.cars[c];
+        out << std::left << std::setw(6) << c + 1
+            << std::right << std::setw(12) << report.numAssigned[c]
+            << std::setw(10) << std::fixed << std::setprecision(2) << r.avgWait << std::setw(10) << r.p99Wait
+            << std::setw(8) << r.motion.GetFloorsTraveled() << std::setw(8) << r.motion.stops << "\n";
+    }
+    out << "Decision time per call: avg " << std::setprecision(1) << report.avgDecisionUs
+        << " us, max " << report.maxDecisionUs << " us\n\n";
+    PrintRunReport(out, report.total);
+}
+
+void PrintBankComparison(std::ostream& out, const std::vector<ElevatorBankReport>& reports) {
+    out << std::left << std::setw(24) << "";
+    for (const auto& r : reports) out << std::right << std::setw(14) << r.dispatch;
+    out << "\n";
+
+    auto row = [&](const char* name, auto value) {
+        out << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2);
+        for (const auto& r : reports) out << std::setw(14) << value(r);
+        out << "\n";
+    };
+    row("Serviced", [](const ElevatorBankReport& r) { return std::to_string(r.total.numServiced) + "/" + std::to_string(r.total.numRequests); });
+    row("Average wait", [](const ElevatorBankReport& r) { return r.total.avgWait; });
+    row("p99 wait", [](const ElevatorBankReport& r) { return r.total.p99Wait; });
+    row("Max wait", [](const ElevatorBankReport& r) { return r.total.maxWait; });
+    row("Floors traveled", [](const ElevatorBankReport& r) { return r.total.motion.GetFloorsTraveled(); });
+    row("Stops", [](const ElevatorBankReport& r) { return r.total.motion.stops; });
+    row("Energy", [](const ElevatorBankReport& r) { return r.total.energyNet; });
+    row("Decision us/call", [](const ElevatorBankReport& r) { return r.avgDecisionUs; });
+}
@@ -0,0 +1,101 @@
+#pragma once
+#ifndef ElevatorBank_h
+#define ElevatorBank_h
+
+#include "ECElevatorSim.h"
+#include "ElevatorReport.h"
+#include "ElevatorTraceReader.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+//*****************************************************************************
+// Bank of cars serving one building. Every car is an ECElevatorSim of its own;
+// a call is assigned to one car when it is made and handed to it with AddRequest
+// (any number of calls per step).
+//
+// Two ways of assigning:
+// - "collective": conventional group control. Only the hall call (floor and
+//   direction) is known, and it goes to the car that can reach it soonest
+// - "destination": destination dispatch. The passenger enters the destination
+//   at a kiosk, so the cost of a car also covers the ride and the extra stops it
+//   would add for everyone on board. Calls made at the same step are assigned
+//   together: greedy placement, then moves between cars while they lower the
+//   total cost, within a time budget per call. Passengers for the same floors
+//   end up in the same car
+//
+// Cars out of service are skipped. Maintenance requests apply to car 1
+
+struct ElevatorBankOptions
+{
+    int numCars = 4;
+    std::string dispatch = "destination";   // "collective" or "destination"
+    std::string strategy = "collective";    // policy of each car
+    double budgetUs = 50.0;                 // optimizer time per call (destination dispatch)
+};
+
+class ElevatorBank
+{
+public:
+    ElevatorBank(int numFloors, const ElevatorBankOptions& options);
+    ~ElevatorBank();
+    ElevatorBank(const ElevatorBank&) = delete;
+    ElevatorBank& operator=(const ElevatorBank&) = delete;
+
+    // Calls made at time (before Simulate(time)); returns the car each call was handed
+    // to (-1 for maintenance requests, which always go to car 1)
+    std::vector<int> Call(const std::vector<ECElevatorSimRequest>& calls, int time);
+
+    void Simulate(int time);
+
+    int GetNumCars() const { return (int)cars.size(); }
+    const ECElevatorSim& GetCar(int car) const { return *cars[car]; }
+
+    // Time spent deciding, per assigned call
+    double GetAverageDecisionUs() const { return numDecisions > 0 ? totalDecisionUs / numDecisions : 0.0; }
+    double GetMaxDecisionUs() const { return maxDecisionUs; }
+
+private:
+    // Stops a car already has (hall calls and drop-offs) plus the ones planned in the current batch
+    struct CarPlan
+    {
+        ElevatorFloorSet stops;
+        int numPassengers = 0;
+    };
+
+    double estimateArrival(int car, const CarPlan& plan, int floorSrc, bool up) const;
+    double estimateCost(int car, const CarPlan& plan, const ECElevatorSimRequest& call) const;
+    bool isAvailable(int car) const { return !outOfService[car]; }
+    bool inBuilding(int floor) const { return floor >= 1 && floor <= numFloors; }
+    int assignCollective(const ECElevatorSimRequest& call);
+    std::vector<int> assignDestination(const std::vector<ECElevatorSimRequest>& calls);
+    CarPlan planOf(int car) const;
+
+    int numFloors;
+    ElevatorBankOptions options;
+    std::vector<ECElevatorSim*> cars;
+    std::vector<bool> outOfService;   // as of the maintenance requests handed out so far
+    double totalDecisionUs;
+    double maxDecisionUs;
+    long long numDecisions;
+};
+
+struct ElevatorBankReport
+{
+    std::string dispatch;
+    std::vector<ElevatorRunReport> cars;
+    std::vector<int> numAssigned;          // passengers per car
+    ElevatorRunReport total;
+    double avgDecisionUs = 0.0;
+    double maxDecisionUs = 0.0;
+};
+
+// Run the trace on a bank (times 0 .. lenSim-1)
+ElevatorBankReport RunBank(const ElevatorTrace& trace, const ElevatorBankOptions& options, const ElevatorEnergyModel& energy);
+
+void PrintBankReport(std::ostream& out, const ElevatorBankReport& report);
+
+// Side by side, one column per report
+void PrintBankComparison(std::ostream& out, const std::vector<ElevatorBankReport>& reports);
+
+#endif
@@ -0,0 +1,225 @@
+#include "ElevatorCampus.h"
+#include "ElevatorRequestPool.h"
+#include "ElevatorStrategyRegistry.h"
+#include "ElevatorParking.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+bool LoadCampus(const std::string& path, std::vector<ElevatorBuilding>& buildings, std::string& error) {
+    std::ifstream fileStream(path);
+    if (!fileStream.is_open()) {
+        error = "couldn't open " + path;
+        return false;
+    }
+
+    //trace paths are relative to the campus file
+    std::string dir;
+    size_t slash = path.find_last_of("/\\");
+    if (slash != std::string::npos) {
+        dir = path.substr(0, slash + 1);
+    }
+
+    std::string line;
+    while (std::getline(fileStream, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::stringstream iss(line);
+        std::string file, name;
+        if (!(iss >> file)) continue;
+        iss >> name;
+
+        ElevatorBuilding building;
+        building.name = name.empty() ? file : name;
+        std::string tracePath = (file[0] == '/' || dir.empty()) ? file : dir + file;
+        if (!LoadElevatorTrace(tracePath, building.trace)) {
+            error = "couldn't open " + tracePath;
+            return false;
+        }
+        buildings.push_back(std::move(building));
+    }
+    return true;
+}
+
+// Barrier for the epoch boundaries; the last thread to arrive runs onComplete
+// before anyone is released
+class ElevatorEpochBarrier
+{
+public:
+    explicit ElevatorEpochBarrier(int count) : numThreads(count), numArrived(0), generation(0) {}
+
+    template <class Callback>
+    void ArriveAndWait(Callback onComplete)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        long long gen = generation;
+        if (++numArrived == numThreads) {
+            onComplete();
+            numArrived = 0;
+            generation++;
+            released.notify_all();
+        }
+        else {
+            released.wait(lock, [this, gen] { return generation != gen; });
+        }
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable released;
+    int numThreads;
+    int numArrived;
+    long long generation;
+};
+
+// Counters a worker publishes for its shard at the end of every epoch, one cache line per worker
+struct alignas(64) ElevatorShardSnapshot
+{
+    long long numWaiting = 0;
+    long long numRiding = 0;
+    long long numServiced = 0;
+    long long totalWait = 0;
+    int numOutOfService = 0;
+};
+
+ElevatorCampusReport RunCampus(const std::vector<ElevatorBuilding>& buildings, const ElevatorRunOptions& options,
+    const ElevatorCampusOptions& campus, std::ostream& progress) {
+    ElevatorCampusReport report;
+    size_t numBuildings = buildings.size();
+    report.names.resize(numBuildings);
+    report.buildings.resize(numBuildings);
+
+    int numWorkers = campus.numWorkers > 0 ? campus.numWorkers : (int)std::thread::hardware_concurrency();
+    numWorkers = std::max(1, std::min(numWorkers, (int)std::max<size_t>(numBuildings, 1)));
+    int epochLength = std::max(1, campus.epochLength);
+    report.numWorkers = numWorkers;
+
+    //largest buildings first, each onto the least loaded worker
+    std::vector<size_t> order(numBuildings);
+    int lenCampus = 0;
+    for (size_t i = 0; i < numBuildings; ++i) {
+        order[i] = i;
+        lenCampus = std::max(lenCampus, buildings[i].trace.lenSim);
+    }
+    std::stable_sort(order.begin(), order.end(), [&buildings](size_t a, size_t b) {
+        return buildings[a].trace.requests.size() > buildings[b].trace.requests.size();
+    });
+    std::vector<std::vector<size_t>> shards(numWorkers);
+    std::vector<size_t> load(numWorkers, 0);
+    for (size_t i : order) {
+        size_t w = std::min_element(load.begin(), load.end()) - load.begin();
+        shards[w].push_back(i);
+        load[w] += buildings[i].trace.requests.size() + 1;
+    }
+
+    int numEpochs = (lenCampus + epochLength - 1) / epochLength;
+    report.numEpochs = numEpochs;
+    std::vector<ElevatorShardSnapshot> snapshots(numWorkers);
+    std::vector<ElevatorWaitSummary> waits(numBuildings);
+    ElevatorEpochBarrier barrier(numWorkers);
+    int epoch = 0;   // only touched by the barrier completion
+
+    auto printEpoch = [&]() {
+        ElevatorShardSnapshot sum;
+        for (const auto& s : snapshots) {
+            sum.numWaiting += s.numWaiting;
+            sum.numRiding += s.numRiding;
+            sum.numServiced += s.numServiced;
+            sum.totalWait += s.totalWait;
+            sum.numOutOfService += s.numOutOfService;
+        }
+        int endTime = std::min(lenCampus, (epoch + 1) * epochLength);
+        epoch++;
+        if (!campus.printEpochs) return;
+        progress << "t=" << std::setw(6) << endTime << "  waiting " << std::setw(6) << sum.numWaiting
+            << "  riding " << std::setw(6) << sum.numRiding << "  serviced " << std::setw(8) << sum.numServiced
+            << "  avg wait " << std::fixed << std::setprecision(2)
+            << (sum.numServiced > 0 ? (double)sum.totalWait / sum.numServiced : 0.0);
+        if (sum.numOutOfService > 0) {
+            progress << "  out of service " << sum.numOutOfService;
+        }
+        progress << std::endl;
+    };
+
+    auto worker = [&](int w) {
+        const std::vector<size_t>& shard = shards[w];
+        std::vector<ECElevatorSim*> sims;
+        for (size_t i : shard) {
+            ECElevatorSim* sim = new ECElevatorSim(buildings[i].trace.numFloors, buildings[i].trace.requests,
+                ElevatorStrategyRegistry::Instance().Create(options.strategy));
+            sim->SetParkingStrategy(CreateParkingStrategy(options.parking, buildings[i].trace.numFloors, options.parkingParams));
+            sims.push_back(sim);
+        }
+
+        for (int e = 0; e < numEpochs; ++e) {
+            int begin = e * epochLength, end = std::min(lenCampus, begin + epochLength);
+            ElevatorShardSnapshot& snap = snapshots[w];
+            snap = ElevatorShardSnapshot();
+            for (size_t k = 0; k < shard.size(); ++k) {
+                ECElevatorSim* sim = sims[k];
+                int endBuilding = std::min(end, buildings[shard[k]].trace.lenSim);
+                for (int t = begin; t < endBuilding; ++t) {
+                    sim->Simulate(t);
+                }
+                const ElevatorLiveStats& stats = sim->GetLiveStats();
+                snap.numWaiting += stats.numWaiting;
+                snap.numRiding += stats.numRiding;
+                snap.numServiced += stats.numServiced;
+                snap.totalWait += stats.totalWait;
+                snap.numOutOfService += sim->IsInMaintenance() ? 1 : 0;
+            }
+            barrier.ArriveAndWait(printEpoch);
+        }
+
+        for (size_t k = 0; k < shard.size(); ++k) {
+            size_t i = shard[k];
+            report.names[i] = buildings[i].name;
+            report.buildings[i] = BuildRunReport(*sims[k], options.energy);
+            report.buildings[i].strategy = options.strategy;
+            waits[i] = sims[k]->GetWaitSummary();
+            delete sims[k];
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int w = 1; w < numWorkers; ++w) {
+        threads.emplace_back(worker, w);
+    }
+    worker(0);
+    for (auto& t : threads) {
+        t.join();
+    }
+    report.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    //merge: counters add up, waits are merged exactly
+    report.total = MergeRunReports(report.buildings, waits, options.energy);
+    report.total.strategy = options.strategy;
+    report.total.parking = options.parking;
+    return report;
+}
+
+void PrintCampusReport(std::ostream& out, const ElevatorCampusReport& report) {
+    out << std::left << std::setw(20) << "Building"
+        << std::right << std::setw(12) << "Serviced" << std::setw(10) << "Avg wait"
+        << std::setw(10) << "p99 wait" << std::setw(10) << "Max wait"
+        << std::setw(8) << "Floors" << std::setw(10) << "Energy" << "\n";
+    for (size_t i = 0; i < report.buildings.size(); ++i) {
+        const ElevatorRunReport& r = report.buildings[i];
+        std::string serviced = std::to_string(r.numServiced) + "/" + std::to_string(r.numRequests);
+        out << std::left << std::setw(20) << report.names[i]
+            << std::right << std::setw(12) << serviced
+            << std::setw(10) << std::fixed << std::setprecision(2) << r.avgWait
+            << std::setw(10) << r.p99Wait << std::setw(10) << r.maxWait
+            << std::setw(8) << r.motion.GetFloorsTraveled() << std::setw(10) << r.energyNet << "\n";
+    }
+
+    out << "\nCampus: " << report.buildings.size() << " buildings on " << report.numWorkers << " worker thread(s), "
+        << report.numEpochs << " epochs, " << std::setprecision(2) << report.wallSeconds << " s\n";
+    PrintRunReport(out, report.total);
+}
@@ -0,0 +1,52 @@
+#pragma once
+#ifndef ElevatorCampus_h
+#define ElevatorCampus_h
+
+#include "ElevatorReport.h"
+#include "ElevatorTraceReader.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+//*****************************************************************************
+// Campus run: many independent buildings (one car each), sharded across worker
+// threads. All buildings advance in lockstep epochs of epochLength steps; at
+// every epoch boundary the workers meet at a barrier and one campus-wide
+// progress line is printed, so the numbers always refer to the same time.
+//
+// Campus file: one building trace file per line (relative to the campus file),
+// optionally followed by a name. Lines starting with '#' are comments
+
+struct ElevatorBuilding
+{
+    std::string name;
+    ElevatorTrace trace;
+};
+
+// Read the campus file and every trace in it; false (with error set) on the first failure
+bool LoadCampus(const std::string& path, std::vector<ElevatorBuilding>& buildings, std::string& error);
+
+struct ElevatorCampusOptions
+{
+    int numWorkers = 0;         // 0: one per hardware thread
+    int epochLength = 100;      // steps between synchronization points
+    bool printEpochs = true;
+};
+
+struct ElevatorCampusReport
+{
+    std::vector<std::string> names;
+    std::vector<ElevatorRunReport> buildings;   // same order as the campus file
+    ElevatorRunReport total;                    // merged: sums, plus waits over all requests
+    int numWorkers = 0;
+    int numEpochs = 0;
+    double wallSeconds = 0.0;
+};
+
+// Simulate every building for its own lenSim (the campus runs until the longest is done)
+ElevatorCampusReport RunCampus(const std::vector<ElevatorBuilding>& buildings, const ElevatorRunOptions& options,
+    const ElevatorCampusOptions& campus, std::ostream& progress);
+
+void PrintCampusReport(std::ostream& out, const ElevatorCampusReport& report);
+
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+#ifndef ElevatorEnergyModel_h
+#define ElevatorEnergyModel_h
+
+#include "ECElevatorSim.h"
+
+//*****************************************************************************
+// Simple energy model on top of ElevatorMotionStats (arbitrary energy units)
+// Going up lifts the car; going down is cheap, and with a regenerative drive
+// part of the lifting energy is fed back when the car descends
+
+class ElevatorEnergyModel
+{
+public:
+    ElevatorEnergyModel() : perFloorUp(1.0), perFloorDown(0.3), perStart(0.5), perStandingTick(0.05), regenEfficiency(0.0) {}
+
+    // Conventional drive, nothing recovered
+    static ElevatorEnergyModel Standard() { return ElevatorEnergyModel(); }
+
+    // Regenerative braking: efficiency is the share of lifting energy recovered per floor down
+    static ElevatorEnergyModel Regenerative(double efficiency = 0.35)
+    {
+        ElevatorEnergyModel model;
+        model.regenEfficiency = efficiency;
+        return model;
+    }
+
+    double Consumed(const ElevatorMotionStats& stats) const
+    {
+        return stats.floorsUp * perFloorUp + stats.floorsDown * perFloorDown + stats.starts * perStart
+            + (stats.dwellTicks + stats.idleTicks) * perStandingTick;
+    }
+    double Recovered(const ElevatorMotionStats& stats) const { return stats.floorsDown * perFloorUp * regenEfficiency; }
+    double Net(const ElevatorMotionStats& stats) const { return Consumed(stats) - Recovered(stats); }
+
+    bool IsRegenerative() const { return regenEfficiency > 0.0; }
+
+    double perFloorUp;        // lifting the car by one floor
+    double perFloorDown;      // lowering the car by one floor (drive losses)
+    double perStart;          // accelerating from standstill
+    double perStandingTick;   // controller, lights and doors while the car stands
+    double regenEfficiency;   // 0 = no regenerative braking
+};
+
+#endif
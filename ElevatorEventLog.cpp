@@ -0,0 +1,200 @@
+#include "ElevatorEventLog.h"
+#include <cstring>
+
+static const char EVENT_LOG_MAGIC[8] = { 'E', 'C', 'E', 'V', 'L', 'O', 'G', '1' };
+static const uint32_t EVENT_LOG_VERSION = 1;
+
+const char* GetEventTypeName(int type) {
+    switch (type) {
+    case EC_SIM_EV_REQUEST_ARRIVED: return "arrived";
+    case EC_SIM_EV_BOARDED: return "boarded";
+    case EC_SIM_EV_ALIGHTED: return "alighted";
+    case EC_SIM_EV_CAR_MOVED: return "moved";
+    case EC_SIM_EV_DIRECTION_CHANGED: return "direction";
+    case EC_SIM_EV_MAINTENANCE_START: return "maintenance-start";
+    case EC_SIM_EV_MAINTENANCE_END: return "maintenance-end";
+    case EC_SIM_EV_WITHDRAWN: return "withdrawn";
+    default: return "unknown";
+    }
+}
+
+// ElevatorEventLog Implementation
+ElevatorEventLog::ElevatorEventLog(size_t recordsPerBuffer)
+    : file(NULL), bufferSize(recordsPerBuffer > 0 ? recordsPerBuffer : 1), numRecords(0), stopping(false) {
+    active.reserve(bufferSize);
+}
+
+ElevatorEventLog::~ElevatorEventLog() {
+    Close();
+}
+
+bool ElevatorEventLog::Open(const std::string& path, int numFloors, int lenSim) {
+    Close();
+    file = fopen(path.c_str(), "wb");
+    if (file == NULL) {
+        return false;
+    }
+
+    ElevatorEventLogHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, EVENT_LOG_MAGIC, sizeof(header.magic));
+    header.version = EVENT_LOG_VERSION;
+    header.recordSize = sizeof(ElevatorEventRecord);
+    header.numFloors = numFloors;
+    header.lenSim = lenSim;
+    fwrite(&header, sizeof(header), 1, file);
+
+    numRecords = 0;
+    stopping = false;
+    writer = std::thread(&ElevatorEventLog::writerLoop, this);
+    return true;
+}
+
+void ElevatorEventLog::Close() {
+    if (file == NULL) {
+        return;
+    }
+    if (!active.empty()) {
+        handOff();
+    }
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+
+    fclose(file);
+    file = NULL;
+}
+
+// Give the full buffer to the writer and continue with a spare one
+void ElevatorEventLog::handOff() {
+    numRecords += active.size();
+    std::vector<ElevatorEventRecord> next;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        pending.push_back(std::move(active));
+        if (!spare.empty()) {
+            next = std::move(spare.back());
+            spare.pop_back();
+        }
+    }
+    wake.notify_one();
+
+    // no spare buffer yet (writer is behind): start a new one rather than wait
+    next.clear();
+    next.reserve(bufferSize);
+    active = std::move(next);
+}
+
+void ElevatorEventLog::writerLoop() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        wake.wait(guard, [this] { return stopping || !pending.empty(); });
+        if (pending.empty() && stopping) {
+            break;
+        }
+
+        std::vector<std::vector<ElevatorEventRecord>> batch;
+        batch.swap(pending);
+        guard.unlock();
+        for (auto& buf : batch) {
+            fwrite(buf.data(), sizeof(ElevatorEventRecord), buf.size(), file);
+            buf.clear();
+        }
+        fflush(file);
+        guard.lock();
+
+        for (auto& buf : batch) {
+            spare.push_back(std::move(buf));
+        }
+    }
+}
+
+// ElevatorEventLogReader Implementation
+ElevatorEventLogReader::ElevatorEventLogReader() : file(NULL), bufferPos(0) {
+    memset(&header, 0, sizeof(header));
+}
+
+ElevatorEventLogReader::~ElevatorEventLogReader() {
+    Close();
+}
+
+bool ElevatorEventLogReader::Open(const std::string& path) {
+    Close();
+    file = fopen(path.c_str(), "rb");
+    if (file == NULL) {
+        return false;
+    }
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, EVENT_LOG_MAGIC, sizeof(header.magic)) != 0 ||
+        header.recordSize != sizeof(ElevatorEventRecord)) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void ElevatorEventLogReader::Close() {
+    if (file != NULL) {
+        fclose(file);
+        file = NULL;
+    }
+    buffer.clear();
+    bufferPos = 0;
+}
+
+bool ElevatorEventLogReader::Next(ElevatorEventRecord& rec) {
+    if (bufferPos >= buffer.size()) {
+        if (file == NULL) {
+            return false;
+        }
+        buffer.resize(16 * 1024);
+        size_t n = fread(buffer.data(), sizeof(ElevatorEventRecord), buffer.size(), file);
+        buffer.resize(n);
+        bufferPos = 0;
+        if (n == 0) {
+            return false;
+        }
+    }
+    rec = buffer[bufferPos++];
+    return true;
+}
+
+bool ElevatorEventLogReader::Seek(uint64_t index) {
+    if (file == NULL) {
+        return false;
+    }
+    buffer.clear();
+    bufferPos = 0;
+    long long offset = (long long)sizeof(header) + (long long)(index * sizeof(ElevatorEventRecord));
+#ifdef _WIN32
+    return _fseeki64(file, offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+bool DecodeEventLog(const std::string& path, FILE* out) {
+    ElevatorEventLogReader reader;
+    if (!reader.Open(path)) {
+        return false;
+    }
+
+    const ElevatorEventLogHeader& header = reader.GetHeader();
+    fprintf(out, "# floors %d, length %d\n", header.numFloors, header.lenSim);
+    fprintf(out, "# time car event floor aux request\n");
+
+    ElevatorEventRecord rec;
+    while (reader.Next(rec)) {
+        fprintf(out, "%d %d %s %d %d ", rec.time, rec.car, GetEventTypeName(rec.type), rec.floor, rec.aux);
+        if (rec.request == EC_SIM_EV_NO_REQUEST) {
+            fprintf(out, "-\n");
+        }
+        else {
+            fprintf(out, "%u\n", rec.request);
+        }
+    }
+    return true;
+}
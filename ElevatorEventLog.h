@@ -0,0 +1,130 @@
+#pragma once
+#ifndef ElevatorEventLog_h
+#define ElevatorEventLog_h
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//*****************************************************************************
+// Binary event log of simulator state transitions
+//
+// File layout (little endian, as written by the host):
+//   ElevatorEventLogHeader, then a sequence of fixed-size ElevatorEventRecord
+
+enum EC_SIM_EVENT_TYPE
+{
+    EC_SIM_EV_REQUEST_ARRIVED = 1,     // floor = source, aux = destination
+    EC_SIM_EV_BOARDED = 2,             // floor = boarding floor, aux = destination
+    EC_SIM_EV_ALIGHTED = 3,            // floor = destination, aux = source
+    EC_SIM_EV_CAR_MOVED = 4,           // floor = new floor, aux = previous floor
+    EC_SIM_EV_DIRECTION_CHANGED = 5,   // floor = car floor, aux = new EC_ELEVATOR_DIR
+    EC_SIM_EV_MAINTENANCE_START = 6,   // floor = car floor
+    EC_SIM_EV_MAINTENANCE_END = 7,     // floor = car floor
+    EC_SIM_EV_WITHDRAWN = 8            // floor = source, aux = destination (gave up waiting)
+};
+
+const uint32_t EC_SIM_EV_NO_REQUEST = 0xFFFFFFFFu;
+
+struct ElevatorEventRecord
+{
+    int32_t time;        // simulation time of the event
+    uint32_t request;    // index of the request, EC_SIM_EV_NO_REQUEST for car events
+    int16_t floor;
+    int16_t aux;
+    uint8_t type;        // EC_SIM_EVENT_TYPE
+    uint8_t car;         // car number (0 for the single-car simulator)
+    uint16_t reserved;
+};
+static_assert(sizeof(ElevatorEventRecord) == 16, "event records must stay 16 bytes");
+
+struct ElevatorEventLogHeader
+{
+    char magic[8];           // "ECEVLOG1"
+    uint32_t version;
+    uint32_t recordSize;
+    int32_t numFloors;
+    int32_t lenSim;
+    uint32_t reserved[2];
+};
+static_assert(sizeof(ElevatorEventLogHeader) == 32, "event log header must stay 32 bytes");
+
+const char* GetEventTypeName(int type);
+
+//*****************************************************************************
+// Append-only writer. Append() only copies into an in-memory buffer; full
+// buffers are handed to a background thread that writes them to disk, so the
+// simulation thread never waits on file I/O
+
+class ElevatorEventLog
+{
+public:
+    // recordsPerBuffer: how many records are collected before a buffer is flushed
+    explicit ElevatorEventLog(size_t recordsPerBuffer = 64 * 1024);
+    ~ElevatorEventLog();
+
+    bool Open(const std::string& path, int numFloors, int lenSim);
+    void Close();   // flushes everything and stops the writer thread
+    bool IsOpen() const { return file != NULL; }
+
+    void Append(const ElevatorEventRecord& rec)
+    {
+        active.push_back(rec);
+        if (active.size() >= bufferSize) {
+            handOff();
+        }
+    }
+
+    uint64_t GetNumRecords() const { return numRecords + active.size(); }
+
+private:
+    void handOff();
+    void writerLoop();
+
+    FILE* file;
+    size_t bufferSize;
+    uint64_t numRecords;                       // records handed to the writer
+    std::vector<ElevatorEventRecord> active;   // filled by the simulation thread
+
+    std::mutex lock;
+    std::condition_variable wake;
+    std::vector<std::vector<ElevatorEventRecord>> pending;   // full buffers to write
+    std::vector<std::vector<ElevatorEventRecord>> spare;     // written buffers for reuse
+    bool stopping;
+    std::thread writer;
+};
+
+//*****************************************************************************
+// Offline reader for event logs
+
+class ElevatorEventLogReader
+{
+public:
+    ElevatorEventLogReader();
+    ~ElevatorEventLogReader();
+
+    bool Open(const std::string& path);   // false if missing or not an event log
+    void Close();
+    const ElevatorEventLogHeader& GetHeader() const { return header; }
+
+    // Next record in the file; false at the end
+    bool Next(ElevatorEventRecord& rec);
+
+    // Jump to the n-th record
+    bool Seek(uint64_t index);
+
+private:
+    FILE* file;
+    ElevatorEventLogHeader header;
+    std::vector<ElevatorEventRecord> buffer;
+    size_t bufferPos;
+};
+
+// Print a log as text, one event per line
+bool DecodeEventLog(const std::string& path, FILE* out);
+
+#endif
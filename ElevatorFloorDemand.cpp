@@ -0,0 +1,112 @@
+#include "ElevatorFloorDemand.h"
+
+// ElevatorFloorDemand Implementation
+ElevatorFloorDemand::ElevatorFloorDemand(int numFloorsIn)
+    : numFloors(numFloorsIn < 1 ? 1 : numFloorsIn), numOutOfRange(0),
+      pickupsUp(numFloors), pickupsDown(numFloors), dropoffs(numFloors), all(numFloors),
+      numPickupsUp(numFloors + 1, 0), numPickupsDown(numFloors + 1, 0), numDropoffs(numFloors + 1, 0), numAll(numFloors + 1, 0),
+      numRidersFrom(numFloors + 1, 0), boardedOnArrival(numFloors + 1, 0), boardedOnArrivalTime(numFloors + 1, -1) {
+}
+
+// add helper method, keeps a floor's bit in step with its count
+void ElevatorFloorDemand::add(ElevatorFloorSet& set, std::vector<int>& counts, int floor, int delta) {
+    int before = counts[floor];
+    counts[floor] += delta;
+    if (before == 0 && counts[floor] > 0) {
+        set.Set(floor);
+    }
+    else if (before > 0 && counts[floor] == 0) {
+        set.Clear(floor);
+    }
+}
+
+void ElevatorFloorDemand::AddWaiting(int floorSrc, int floorDest) {
+    if (!inRange(floorSrc) || !inRange(floorDest)) {
+        numOutOfRange++;
+        return;
+    }
+    if (floorDest > floorSrc) {
+        add(pickupsUp, numPickupsUp, floorSrc, 1);
+    }
+    else {
+        add(pickupsDown, numPickupsDown, floorSrc, 1);
+    }
+    add(all, numAll, floorSrc, 1);
+}
+
+void ElevatorFloorDemand::Board(int floorSrc, int floorDest, int timeMade, int time) {
+    if (!inRange(floorSrc) || !inRange(floorDest)) {
+        return;   // still counted as out of range until it alights
+    }
+    if (floorDest > floorSrc) {
+        add(pickupsUp, numPickupsUp, floorSrc, -1);
+    }
+    else {
+        add(pickupsDown, numPickupsDown, floorSrc, -1);
+    }
+    add(all, numAll, floorSrc, -1);
+    add(dropoffs, numDropoffs, floorDest, 1);
+    add(all, numAll, floorDest, 1);
+
+    numRidersFrom[floorSrc]++;
+    if (timeMade == time) {
+        if (boardedOnArrivalTime[floorSrc] != time) {
+            boardedOnArrivalTime[floorSrc] = time;
+            boardedOnArrival[floorSrc] = 0;
+        }
+        boardedOnArrival[floorSrc]++;
+    }
+}
+
+void ElevatorFloorDemand::Alight(int floorSrc, int floorDest, int timeMade, int time) {
+    if (!inRange(floorSrc) || !inRange(floorDest)) {
+        numOutOfRange--;
+        return;
+    }
+    add(dropoffs, numDropoffs, floorDest, -1);
+    add(all, numAll, floorDest, -1);
+
+    numRidersFrom[floorSrc]--;
+    //made this step, so it also boarded this step
+    if (timeMade == time && boardedOnArrivalTime[floorSrc] == time) {
+        boardedOnArrival[floorSrc]--;
+    }
+}
+
+// HasEarlierRiderFrom: riders from floor, less those made (and so boarded) at time
+bool ElevatorFloorDemand::HasEarlierRiderFrom(int floor, int time) const {
+    if (!inRange(floor)) {
+        return false;
+    }
+    int madeNow = boardedOnArrivalTime[floor] == time ? boardedOnArrival[floor] : 0;
+    return numRidersFrom[floor] > madeNow;
+}
+
+void ElevatorFloorDemand::Withdraw(int floorSrc, int floorDest) {
+    if (!inRange(floorSrc) || !inRange(floorDest)) {
+        numOutOfRange--;
+        return;
+    }
+    if (floorDest > floorSrc) {
+        add(pickupsUp, numPickupsUp, floorSrc, -1);
+    }
+    else {
+        add(pickupsDown, numPickupsDown, floorSrc, -1);
+    }
+    add(all, numAll, floorSrc, -1);
+}
+
+// GetNearest: the closest set bits on either side of floor
+int ElevatorFloorDemand::GetNearest(int floor) const {
+    if (all.IsEmpty()) {
+        return -1;
+    }
+    if (HasAt(floor)) {
+        return floor;
+    }
+    int below = all.NextBelow(floor);
+    int above = all.NextAbove(floor);
+    if (below == -1) return above;
+    if (above == -1) return below;
+    return (floor - below <= above - floor) ? below : above;
+}
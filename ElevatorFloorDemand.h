@@ -0,0 +1,197 @@
+#pragma once
+#ifndef ElevatorFloorDemand_h
+#define ElevatorFloorDemand_h
+
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+//*****************************************************************************
+// Bit scans on 64-bit words (x must not be 0)
+
+inline int ECLowestBit(uint64_t x)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return (int)index;
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+inline int ECHighestBit(uint64_t x)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, x);
+    return (int)index;
+#else
+    return 63 - __builtin_clzll(x);
+#endif
+}
+
+inline int ECCountBits(uint64_t x)
+{
+#if defined(_MSC_VER)
+    return (int)__popcnt64(x);
+#else
+    return __builtin_popcountll(x);
+#endif
+}
+
+//*****************************************************************************
+// Set of floors, bit f-1 for floor f. Buildings up to 64 floors use one inline
+// word; taller ones get a runtime-sized word array. All queries are word-wise
+// bit scans (a single one for the common case)
+
+class ElevatorFloorSet
+{
+public:
+    explicit ElevatorFloorSet(int numFloors = 64) { Resize(numFloors); }
+
+    ElevatorFloorSet(const ElevatorFloorSet& rhs) : small(rhs.small), large(rhs.large), numWords(rhs.numWords)
+    {
+        words = large.empty() ? &small : large.data();
+    }
+    ElevatorFloorSet& operator=(const ElevatorFloorSet& rhs)
+    {
+        small = rhs.small;
+        large = rhs.large;
+        numWords = rhs.numWords;
+        words = large.empty() ? &small : large.data();
+        return *this;
+    }
+
+    void Resize(int numFloors)
+    {
+        numWords = numFloors <= 64 ? 1 : (numFloors + 63) / 64;
+        small = 0;
+        large.assign(numWords > 1 ? numWords : 0, 0);
+        words = large.empty() ? &small : large.data();
+    }
+
+    int GetCapacity() const { return numWords * 64; }   // floors 1 .. capacity
+
+    void Set(int floor) { words[(floor - 1) >> 6] |= 1ULL << ((floor - 1) & 63); }
+    void Clear(int floor) { words[(floor - 1) >> 6] &= ~(1ULL << ((floor - 1) & 63)); }
+    bool Test(int floor) const { return (words[(floor - 1) >> 6] >> ((floor - 1) & 63)) & 1; }
+
+    bool IsEmpty() const
+    {
+        for (int i = 0; i < numWords; ++i) {
+            if (words[i]) return false;
+        }
+        return true;
+    }
+
+    int Count() const
+    {
+        int count = 0;
+        for (int i = 0; i < numWords; ++i) {
+            count += ECCountBits(words[i]);
+        }
+        return count;
+    }
+
+    // Lowest floor > floor in the set, -1 if none
+    int NextAbove(int floor) const
+    {
+        int bit = floor;   // bit of floor + 1
+        if (bit < 0) bit = 0;
+        for (int i = bit >> 6; i < numWords; ++i) {
+            uint64_t w = words[i];
+            if (i == (bit >> 6)) {
+                w &= ~0ULL << (bit & 63);
+            }
+            if (w) return i * 64 + ECLowestBit(w) + 1;
+        }
+        return -1;
+    }
+
+    // Highest floor < floor in the set, -1 if none
+    int NextBelow(int floor) const
+    {
+        int bit = floor - 2;   // bit of floor - 1
+        if (bit < 0) return -1;
+        if (bit >= numWords * 64) bit = numWords * 64 - 1;
+        for (int i = bit >> 6; i >= 0; --i) {
+            uint64_t w = words[i];
+            if (i == (bit >> 6) && (bit & 63) != 63) {
+                w &= (1ULL << ((bit & 63) + 1)) - 1;
+            }
+            if (w) return i * 64 + ECHighestBit(w) + 1;
+        }
+        return -1;
+    }
+
+private:
+    uint64_t small;
+    std::vector<uint64_t> large;
+    uint64_t* words;
+    int numWords;
+};
+
+//*****************************************************************************
+// Outstanding demand of one car, per floor: hall calls going up, hall calls
+// going down, and drop-offs of riders. Per-floor counts back the bits, so the
+// bit for a floor is cleared when its last request is gone.
+//
+// Requests for floors outside 1..numFloors can't be represented; while any is
+// outstanding IsExact() is false and callers fall back to scanning requests
+
+class ElevatorFloorDemand
+{
+public:
+    explicit ElevatorFloorDemand(int numFloors = 1);
+
+    // A passenger starts waiting / boards / alights
+    // (timeMade: when the request was made, time: now)
+    void AddWaiting(int floorSrc, int floorDest);
+    void Board(int floorSrc, int floorDest, int timeMade, int time);
+    void Alight(int floorSrc, int floorDest, int timeMade, int time);
+    void Withdraw(int floorSrc, int floorDest);   // a waiting passenger leaves
+
+    bool IsExact() const { return numOutOfRange == 0; }
+
+    const ElevatorFloorSet& GetPickupsUp() const { return pickupsUp; }
+    const ElevatorFloorSet& GetPickupsDown() const { return pickupsDown; }
+    const ElevatorFloorSet& GetDropoffs() const { return dropoffs; }
+
+    // Any floor to be served: hall calls plus drop-offs
+    const ElevatorFloorSet& GetAll() const { return all; }
+
+    bool HasAt(int floor) const { return inRange(floor) && all.Test(floor); }
+    bool HasAbove(int floor) const { return all.NextAbove(floor) != -1; }
+    bool HasBelow(int floor) const { return all.NextBelow(floor) != -1; }
+    bool HasAny() const { return !all.IsEmpty(); }
+    bool HasPickupAt(int floor) const { return inRange(floor) && (pickupsUp.Test(floor) || pickupsDown.Test(floor)); }
+    bool HasDropoffAt(int floor) const { return inRange(floor) && dropoffs.Test(floor); }
+
+    // A rider got on at floor with a request made before time (riders made later
+    // than time must not exist, i.e. the requests up to time have been taken in)
+    bool HasEarlierRiderFrom(int floor, int time) const;
+
+    // Served floor closest to floor (ties go to the lower floor), -1 if none
+    int GetNearest(int floor) const;
+
+    // Number of distinct floors to serve
+    int GetNumFloorsWithDemand() const { return all.Count(); }
+
+private:
+    bool inRange(int floor) const { return floor >= 1 && floor <= numFloors; }
+    void add(ElevatorFloorSet& set, std::vector<int>& counts, int floor, int delta);
+
+    int numFloors;
+    int numOutOfRange;
+    ElevatorFloorSet pickupsUp, pickupsDown, dropoffs, all;
+    std::vector<int> numPickupsUp, numPickupsDown, numDropoffs, numAll;
+    std::vector<int> numRidersFrom;        // riders per floor they got on at
+    std::vector<int> boardedOnArrival;     // of those, riders who boarded the step their request was made...
+    std::vector<int> boardedOnArrivalTime; // ... at this time
+};
+
+#endif
@@ -0,0 +1,361 @@
+#include "ElevatorFuzz.h"
+#include "ElevatorReferenceSim.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+static const char* DirName(EC_ELEVATOR_DIR dir) {
+    return dir == EC_ELEVATOR_UP ? "up" : (dir == EC_ELEVATOR_DOWN ? "down" : "stopped");
+}
+
+static const char* StateName(EC_REQUEST_STATE state) {
+    switch (state) {
+    case EC_REQUEST_PENDING: return "pending";
+    case EC_REQUEST_WAITING: return "waiting";
+    case EC_REQUEST_RIDING: return "riding";
+    case EC_REQUEST_SERVICED: return "serviced";
+    case EC_REQUEST_WITHDRAWN: return "withdrawn";
+    default: return "unknown";
+    }
+}
+
+// A floor for a random request: mostly inside the building, sometimes just outside
+static int RandomFloor(std::mt19937& rng, int numFloors, bool outOfRange) {
+    if (outOfRange) {
+        int offset = std::uniform_int_distribution<int>(1, 3)(rng);
+        return (rng() & 1) ? 1 - offset : numFloors + offset;
+    }
+    return std::uniform_int_distribution<int>(1, numFloors)(rng);
+}
+
+ElevatorFuzzCase GenerateFuzzCase(std::mt19937& rng) {
+    ElevatorFuzzCase fuzzCase;
+    auto uniform = [&rng](int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(rng); };
+
+    //mostly small buildings, some around and past the 64 floors of one demand word
+    int size = uniform(0, 19);
+    fuzzCase.numFloors = size < 10 ? uniform(2, 10) : (size < 17 ? uniform(11, 70) : uniform(60, 200));
+    fuzzCase.lenSim = uniform(10, 400);
+
+    int numRequests = uniform(1, 150);
+    bool bursty = uniform(0, 3) == 0;          // requests made at a few shared times
+    bool outOfRange = uniform(0, 9) == 0;      // a few requests for floors outside the building
+    int numBurstTimes = uniform(1, 5);
+    std::vector<int> burstTimes;
+    for (int i = 0; i < numBurstTimes; ++i) {
+        burstTimes.push_back(uniform(0, fuzzCase.lenSim - 1));
+    }
+
+    //busy floors (lobby, cafeteria): several passengers waiting at the same floor
+    std::vector<int> hotFloors;
+    int numHotFloors = uniform(0, 3);
+    for (int i = 0; i < numHotFloors; ++i) {
+        hotFloors.push_back(uniform(1, fuzzCase.numFloors));
+    }
+
+    std::vector<ECElevatorSimRequest> requests;
+    for (int i = 0; i < numRequests; ++i) {
+        int time = bursty ? burstTimes[uniform(0, numBurstTimes - 1)] : uniform(0, fuzzCase.lenSim - 1);
+        int src, dest;
+        do {
+            src = RandomFloor(rng, fuzzCase.numFloors, outOfRange && uniform(0, 19) == 0);
+            dest = RandomFloor(rng, fuzzCase.numFloors, outOfRange && uniform(0, 19) == 0);
+            if (!hotFloors.empty() && uniform(0, 1) == 0) {
+                int hot = hotFloors[uniform(0, numHotFloors - 1)];
+                if (uniform(0, 1) == 0) src = hot; else dest = hot;
+            }
+        } while (src == dest);
+        requests.push_back(ECElevatorSimRequest(time, src, dest));
+    }
+
+    //maintenance periods
+    if (uniform(0, 4) == 0) {
+        int numPeriods = uniform(1, 3);
+        for (int i = 0; i < numPeriods; ++i) {
+            int start = uniform(0, fuzzCase.lenSim - 1);
+            requests.push_back(ECElevatorSimRequest(start, -1, -1));
+            if (uniform(0, 4) != 0) {
+                requests.push_back(ECElevatorSimRequest(uniform(start, fuzzCase.lenSim - 1), 0, 0));
+            }
+        }
+    }
+    std::shuffle(requests.begin(), requests.end(), rng);
+
+    //a tail of the list is fed through Submit, each no later than its request time
+    size_t numInitial = requests.size();
+    if (uniform(0, 2) == 0) {
+        numInitial = uniform(0, (int)requests.size());
+    }
+    std::vector<std::pair<int, size_t>> submitted;
+    for (size_t i = numInitial; i < requests.size(); ++i) {
+        submitted.push_back(std::make_pair(uniform(0, std::max(0, requests[i].GetTime())), i));
+    }
+    std::sort(submitted.begin(), submitted.end());
+
+    for (size_t i = 0; i < numInitial; ++i) {
+        fuzzCase.requests.push_back(requests[i]);
+        fuzzCase.submitAt.push_back(-1);
+    }
+    for (const auto& s : submitted) {
+        fuzzCase.requests.push_back(requests[s.second]);
+        fuzzCase.submitAt.push_back(s.first);
+    }
+    return fuzzCase;
+}
+
+// compareStep helper function, first difference between the engines after a step ("" if none)
+static std::string CompareStep(const ECElevatorSim& sim, const ElevatorReferenceSim& ref, int time) {
+    std::ostringstream diff;
+    if (sim.GetCurrFloor() != ref.GetCurrFloor()) {
+        diff << "car floor " << sim.GetCurrFloor() << " (reference " << ref.GetCurrFloor() << ")";
+        return diff.str();
+    }
+    if (sim.GetCurrDir() != ref.GetCurrDir()) {
+        diff << "direction " << DirName(sim.GetCurrDir()) << " (reference " << DirName(ref.GetCurrDir()) << ")";
+        return diff.str();
+    }
+    if (sim.IsInMaintenance() != ref.IsInMaintenance()) {
+        diff << "maintenance " << sim.IsInMaintenance() << " (reference " << ref.IsInMaintenance() << ")";
+        return diff.str();
+    }
+
+    const std::vector<ECElevatorSimRequest>& requests = ref.GetRequests();
+    for (size_t i = 0; i < requests.size(); ++i) {
+        EC_REQUEST_STATE expected = ref.GetState(i, time);
+        if (expected == EC_REQUEST_PENDING) continue;   // covered by the counters below
+
+        ElevatorRequestResult result;
+        if (!sim.GetResult((ElevatorRequestHandle)i, result)) {
+            result.state = EC_REQUEST_UNKNOWN;
+        }
+        int expectedArrive = expected == EC_REQUEST_SERVICED ? requests[i].GetArriveTime() : -1;
+        int arrive = result.state == EC_REQUEST_SERVICED ? result.arriveTime : -1;
+        if (result.state != expected || arrive != expectedArrive) {
+            diff << "request " << i << " (" << requests[i].GetTime() << " " << requests[i].GetFloorSrc() << " "
+                << requests[i].GetFloorDest() << ") " << StateName(result.state);
+            if (arrive != -1) diff << " at " << arrive;
+            diff << " (reference " << StateName(expected);
+            if (expectedArrive != -1) diff << " at " << expectedArrive;
+            diff << ")";
+            return diff.str();
+        }
+    }
+
+    int numWaiting, numRiding, numServiced;
+    ref.CountPassengers(time, numWaiting, numRiding, numServiced);
+    const ElevatorLiveStats& stats = sim.GetLiveStats();
+    if (stats.numWaiting != numWaiting || stats.numRiding != numRiding || stats.numServiced != numServiced) {
+        diff << "waiting/riding/serviced " << stats.numWaiting << "/" << stats.numRiding << "/" << stats.numServiced
+            << " (reference " << numWaiting << "/" << numRiding << "/" << numServiced << ")";
+        return diff.str();
+    }
+    return "";
+}
+
+ElevatorFuzzDivergence RunLockstep(const ElevatorFuzzCase& fuzzCase) {
+    size_t numRequests = fuzzCase.requests.size();
+    size_t numInitial = 0;
+    while (numInitial < numRequests && fuzzCase.submitAt[numInitial] < 0) {
+        numInitial++;
+    }
+
+    ECElevatorSim sim(fuzzCase.numFloors, std::vector<ECElevatorSimRequest>(fuzzCase.requests.begin(),
+        fuzzCase.requests.begin() + numInitial));
+    sim.SetRetainResults(true);   // every request is compared, finished or not
+    ElevatorReferenceSim ref(fuzzCase.numFloors, fuzzCase.requests);
+
+    ElevatorFuzzDivergence divergence;
+    size_t nextSubmit = numInitial;
+    for (int t = 0; t < fuzzCase.lenSim; ++t) {
+        while (nextSubmit < numRequests && fuzzCase.submitAt[nextSubmit] <= t) {
+            sim.AddRequest(fuzzCase.requests[nextSubmit++]);
+        }
+        sim.Simulate(t);
+        ref.Simulate(t);
+
+        std::string what = CompareStep(sim, ref, t);
+        if (!what.empty()) {
+            divergence.diverged = true;
+            divergence.time = t;
+            divergence.what = what;
+            break;
+        }
+    }
+    return divergence;
+}
+
+// subset helper function, the case with only the requests listed in keep (order kept)
+static ElevatorFuzzCase Subset(const ElevatorFuzzCase& fuzzCase, const std::vector<size_t>& keep) {
+    ElevatorFuzzCase reduced;
+    reduced.numFloors = fuzzCase.numFloors;
+    reduced.lenSim = fuzzCase.lenSim;
+    for (size_t i : keep) {
+        reduced.requests.push_back(fuzzCase.requests[i]);
+        reduced.submitAt.push_back(fuzzCase.submitAt[i]);
+    }
+    return reduced;
+}
+
+ElevatorFuzzCase MinimizeFuzzCase(const ElevatorFuzzCase& fuzzCase) {
+    ElevatorFuzzCase best = fuzzCase;
+
+    //delta debugging over the requests: drop chunks while it still diverges
+    std::vector<size_t> keep(best.requests.size());
+    for (size_t i = 0; i < keep.size(); ++i) keep[i] = i;
+    size_t granularity = 2;
+    while (keep.size() >= 2) {
+        size_t chunk = (keep.size() + granularity - 1) / granularity;
+        bool reduced = false;
+        for (size_t begin = 0; begin < keep.size(); begin += chunk) {
+            std::vector<size_t> complement(keep.begin(), keep.begin() + begin);
+            complement.insert(complement.end(), keep.begin() + std::min(keep.size(), begin + chunk), keep.end());
+            if (!complement.empty() && RunLockstep(Subset(best, complement)).diverged) {
+                keep = complement;
+                granularity = std::max<size_t>(granularity - 1, 2);
+                reduced = true;
+                break;
+            }
+        }
+        if (!reduced) {
+            if (granularity >= keep.size()) break;
+            granularity = std::min(keep.size(), granularity * 2);
+        }
+    }
+    best = Subset(best, keep);
+
+    //submitted requests: try them in the constructor list instead
+    for (size_t i = 0; i < best.requests.size(); ++i) {
+        if (best.submitAt[i] < 0) continue;
+        ElevatorFuzzCase moved = best;
+        size_t numInitial = 0;
+        while (moved.submitAt[numInitial] < 0) numInitial++;
+        ECElevatorSimRequest req = moved.requests[i];
+        moved.requests.erase(moved.requests.begin() + i);
+        moved.submitAt.erase(moved.submitAt.begin() + i);
+        moved.requests.insert(moved.requests.begin() + numInitial, req);
+        moved.submitAt.insert(moved.submitAt.begin() + numInitial, -1);
+        if (RunLockstep(moved).diverged) best = moved;
+    }
+
+    //everything made earlier, stop right after the divergence, then try fewer floors
+    int earliest = INT_MAX;
+    for (const auto& req : best.requests) earliest = std::min(earliest, req.GetTime());
+    if (earliest > 0 && earliest != INT_MAX) {
+        ElevatorFuzzCase shifted = best;
+        std::vector<ECElevatorSimRequest> requests;
+        requests.reserve(best.requests.size());
+        for (size_t i = 0; i < best.requests.size(); ++i) {
+            const ECElevatorSimRequest& req = best.requests[i];
+            requests.push_back(ECElevatorSimRequest(req.GetTime() - earliest, req.GetFloorSrc(), req.GetFloorDest()));
+            if (shifted.submitAt[i] >= 0) shifted.submitAt[i] = std::max(0, shifted.submitAt[i] - earliest);
+        }
+        shifted.requests.swap(requests);
+        if (RunLockstep(shifted).diverged) best = shifted;
+    }
+    best.lenSim = RunLockstep(best).time + 1;
+    while (best.numFloors > 2) {
+        ElevatorFuzzCase smaller = best;
+        smaller.numFloors--;
+        if (!RunLockstep(smaller).diverged) break;
+        best = smaller;
+    }
+    return best;
+}
+
+bool WriteFuzzCase(const std::string& path, const ElevatorFuzzCase& fuzzCase, const ElevatorFuzzDivergence& divergence) {
+    std::ofstream fileStream(path);
+    if (!fileStream.is_open()) {
+        return false;
+    }
+
+    fileStream << "# fuzzer reproducer: diverges at t=" << divergence.time << ": " << divergence.what << "\n"
+        << "# run with --fuzz-check <file>\n"
+        << fuzzCase.numFloors << " " << fuzzCase.lenSim << "\n";
+    for (size_t i = 0; i < fuzzCase.requests.size(); ++i) {
+        const ECElevatorSimRequest& req = fuzzCase.requests[i];
+        fileStream << req.GetTime() << " " << req.GetFloorSrc() << " " << req.GetFloorDest();
+        if (fuzzCase.submitAt[i] >= 0) {
+            fileStream << " submit " << fuzzCase.submitAt[i];
+        }
+        fileStream << "\n";
+    }
+    return true;
+}
+
+bool LoadFuzzCase(const std::string& path, ElevatorFuzzCase& fuzzCase) {
+    std::ifstream fileStream(path);
+    if (!fileStream.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    bool header = false;
+    while (std::getline(fileStream, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::stringstream iss(line);
+        if (!header) {
+            iss >> fuzzCase.numFloors >> fuzzCase.lenSim;
+            header = true;
+            continue;
+        }
+
+        int time, src, dest;
+        if (!(iss >> time >> src >> dest)) continue;
+        std::string keyword;
+        int submitAt = -1;
+        if (iss >> keyword >> submitAt && keyword != "submit") {
+            submitAt = -1;
+        }
+        fuzzCase.requests.push_back(ECElevatorSimRequest(time, src, dest));
+        fuzzCase.submitAt.push_back(submitAt);
+    }
+
+    //keep the invariant: constructor requests first, submitted ones by step
+    std::vector<size_t> order(fuzzCase.requests.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&fuzzCase](size_t a, size_t b) {
+        return fuzzCase.submitAt[a] < fuzzCase.submitAt[b];
+    });
+    fuzzCase = Subset(fuzzCase, order);
+    return header;
+}
+
+int RunFuzz(const ElevatorFuzzOptions& options, std::ostream& out) {
+    for (int k = 0; k < options.iterations; ++k) {
+        uint32_t seed = options.seed + (uint32_t)k;
+        std::mt19937 rng(seed);
+        ElevatorFuzzCase fuzzCase = GenerateFuzzCase(rng);
+        ElevatorFuzzDivergence divergence = RunLockstep(fuzzCase);
+        if (!divergence.diverged) continue;
+
+        out << "Case " << k << " (--seed " << seed << " --fuzz 1): " << fuzzCase.requests.size() << " requests, "
+            << fuzzCase.numFloors << " floors, diverges at t=" << divergence.time << ": " << divergence.what << std::endl;
+
+        ElevatorFuzzCase minimized = MinimizeFuzzCase(fuzzCase);
+        ElevatorFuzzDivergence minDivergence = RunLockstep(minimized);
+        out << "Minimized to " << minimized.requests.size() << " requests, " << minimized.numFloors << " floors, "
+            << minimized.lenSim << " steps; diverges at t=" << minDivergence.time << ": " << minDivergence.what << std::endl;
+        if (WriteFuzzCase(options.reproFile, minimized, minDivergence)) {
+            out << "Reproducer written to " << options.reproFile << std::endl;
+        }
+        return 1;
+    }
+    out << options.iterations << " cases (seeds " << options.seed << ".." << options.seed + options.iterations - 1
+        << "): engines agree" << std::endl;
+    return 0;
+}
+
+int CheckFuzzCase(const std::string& path, std::ostream& out) {
+    ElevatorFuzzCase fuzzCase;
+    if (!LoadFuzzCase(path, fuzzCase)) {
+        out << "Couldn't read " << path << std::endl;
+        return 1;
+    }
+    ElevatorFuzzDivergence divergence = RunLockstep(fuzzCase);
+    if (divergence.diverged) {
+        out << "Diverges at t=" << divergence.time << ": " << divergence.what << std::endl;
+        return 1;
+    }
+    out << "Engines agree for all " << fuzzCase.lenSim << " steps" << std::endl;
+    return 0;
+}
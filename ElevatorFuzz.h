@@ -0,0 +1,63 @@
+#pragma once
+#ifndef ElevatorFuzz_h
+#define ElevatorFuzz_h
+
+#include "ECElevatorSim.h"
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+//*****************************************************************************
+// Differential fuzzer: random buildings and request traces are run through
+// ECElevatorSim and ElevatorReferenceSim in lockstep (default policy). After
+// every step the car (floor, direction, maintenance), the passenger counters and
+// the state/arrive time of every request made so far have to agree. The first
+// step where they don't is reported, and the trace is shrunk (delta debugging
+// over the requests, then fewer steps and floors) to a small reproducer.
+//
+// Some requests of a case are fed with Submit instead of the constructor list,
+// at a random step no later than their request time
+
+struct ElevatorFuzzCase
+{
+    int numFloors = 0;
+    int lenSim = 0;
+    std::vector<ECElevatorSimRequest> requests;   // reference order = handle order
+    std::vector<int> submitAt;   // per request: -1 in the constructor list, else submitted before this step;
+                                 // constructor requests come first, submitted ones by submitAt
+};
+
+struct ElevatorFuzzDivergence
+{
+    bool diverged = false;
+    int time = -1;          // first step that differs
+    std::string what;       // what differs, optimized value first
+};
+
+struct ElevatorFuzzOptions
+{
+    int iterations = 1000;
+    uint32_t seed = 1;                      // case k uses seed + k
+    std::string reproFile = "fuzz-repro.txt";
+};
+
+ElevatorFuzzCase GenerateFuzzCase(std::mt19937& rng);
+ElevatorFuzzDivergence RunLockstep(const ElevatorFuzzCase& fuzzCase);
+
+// Smallest case found that still diverges
+ElevatorFuzzCase MinimizeFuzzCase(const ElevatorFuzzCase& fuzzCase);
+
+// Reproducer file: a trace file; submitted requests carry "submit <step>" after
+// the three numbers (plain trace readers ignore it)
+bool WriteFuzzCase(const std::string& path, const ElevatorFuzzCase& fuzzCase, const ElevatorFuzzDivergence& divergence);
+bool LoadFuzzCase(const std::string& path, ElevatorFuzzCase& fuzzCase);
+
+// Returns 0 if no case diverged, 1 otherwise (the reproducer is written)
+int RunFuzz(const ElevatorFuzzOptions& options, std::ostream& out);
+
+// Run one reproducer (or any trace file) in lockstep; 0 if the engines agree
+int CheckFuzzCase(const std::string& path, std::ostream& out);
+
+#endif
@@ -0,0 +1,389 @@
+#include "ElevatorGolden.h"
+#include "ElevatorBank.h"
+#include "ElevatorReport.h"
+#include "ElevatorStrategyRegistry.h"
+#include "ElevatorTraceReader.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+// Resident memory now and its high-water mark. On Linux the high-water mark can
+// be reset, so the growth covers one scenario exactly; elsewhere it is how far
+// the scenario pushed the peak of the whole process
+static void ResetPeakRss() {
+#if defined(__linux__)
+    FILE* f = fopen("/proc/self/clear_refs", "w");
+    if (f) {
+        fputs("5", f);
+        fclose(f);
+    }
+#endif
+}
+
+#if defined(__linux__)
+// ReadStatusKb helper function, a "<field>: <n> kB" line of /proc/self/status
+static long ReadStatusKb(const char* field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    size_t len = strlen(field);
+    while (std::getline(status, line)) {
+        if (line.compare(0, len, field) == 0) {
+            return std::atol(line.c_str() + len);
+        }
+    }
+    return 0;
+}
+#endif
+
+static long GetCurrentRssKb() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return (long)(counters.WorkingSetSize / 1024);
+    }
+    return 0;
+#elif defined(__linux__)
+    return ReadStatusKb("VmRSS:");
+#else
+    return 0;
+#endif
+}
+
+static long GetPeakRssKb() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return (long)(counters.PeakWorkingSetSize / 1024);
+    }
+    return 0;
+#else
+#if defined(__linux__)
+    long hwm = ReadStatusKb("VmHWM:");
+    if (hwm > 0) return hwm;
+#endif
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return (long)(usage.ru_maxrss / 1024);   // bytes
+#else
+    return (long)usage.ru_maxrss;            // kilobytes
+#endif
+#endif
+}
+
+// FNV-1a over the bytes of a value
+static uint64_t HashValue(uint64_t hash, int64_t value) {
+    for (int b = 0; b < 8; ++b) {
+        hash ^= (uint8_t)((uint64_t)value >> (8 * b));
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// HashReport helper function, adds the counters and the energy of a run
+static uint64_t HashReport(uint64_t hash, const ElevatorRunReport& report) {
+    const ElevatorMotionStats& m = report.motion;
+    for (int value : { report.numRequests, report.numServiced, report.numWithdrawn, m.floorsUp, m.floorsDown,
+        m.starts, m.stops, m.reversals, m.movingTicks, m.dwellTicks, m.idleTicks, m.parkingTicks,
+        m.maintenanceTicks, m.maintenancePeriods }) {
+        hash = HashValue(hash, value);
+    }
+    return HashValue(hash, std::llround(report.energyNet * 1000.0));
+}
+
+uint64_t HashArriveTimes(const ECElevatorSim& sim, int numRequests) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; i < numRequests; ++i) {
+        ElevatorRequestResult result;
+        int32_t arrive = -1;
+        if (sim.GetResult((ElevatorRequestHandle)i, result) && result.state == EC_REQUEST_SERVICED) {
+            arrive = result.arriveTime;
+        }
+        for (int b = 0; b < 4; ++b) {
+            hash ^= (uint8_t)((uint32_t)arrive >> (8 * b));
+            hash *= 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+bool LoadGoldenFile(const std::string& path, std::vector<ElevatorGoldenEntry>& entries) {
+    std::ifstream fileStream(path);
+    if (!fileStream.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(fileStream, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::stringstream iss(line);
+        ElevatorGoldenEntry entry;
+        if (!(iss >> entry.scenario >> entry.strategy)) continue;
+        std::string hash;
+        if (iss >> hash >> entry.cost >> entry.rssGrowthKb) {
+            entry.hash = std::strtoull(hash.c_str(), NULL, 16);
+            entry.hasValues = true;
+        }
+        entries.push_back(entry);
+    }
+    return true;
+}
+
+bool WriteGoldenFile(const std::string& path, const std::vector<ElevatorGoldenEntry>& entries) {
+    std::ofstream fileStream(path);
+    if (!fileStream.is_open()) {
+        return false;
+    }
+
+    fileStream << "# <input-file> <strategy>[,parking=<policy>][,regen=<efficiency>][,bank=<cars>] <result hash> <cost> <rss growth kb>\n"
+               << "# written by --golden <file> --update-golden; cost = time of one run / time of a fixed reference work\n";
+    for (const auto& e : entries) {
+        fileStream << e.scenario << " " << e.strategy;
+        if (e.hasValues) {
+            char hash[32];
+            snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)e.hash);
+            fileStream << " " << hash << " " << std::fixed << std::setprecision(5) << e.cost << " " << e.rssGrowthKb;
+        }
+        fileStream << "\n";
+    }
+    return true;
+}
+
+// What a scenario runs, parsed from its setup
+struct ElevatorGoldenSetup
+{
+    ElevatorRunOptions run;
+    int numCars = 0;   // > 0: a bank with collective dispatch
+};
+
+static bool ParseSetup(const std::string& text, ElevatorGoldenSetup& setup, std::string& error) {
+    std::stringstream iss(text);
+    std::string item;
+    std::getline(iss, setup.run.strategy, ',');
+    if (!ElevatorStrategyRegistry::Instance().Contains(setup.run.strategy)) {
+        error = "unknown strategy: " + setup.run.strategy;
+        return false;
+    }
+    while (std::getline(iss, item, ',')) {
+        size_t eq = item.find('=');
+        std::string key = item.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : item.substr(eq + 1);
+        char* end = NULL;
+        double number = std::strtod(value.c_str(), &end);
+        bool isNumber = !value.empty() && *end == '\0';
+
+        if (key == "parking" && IsParkingStrategy(value)) {
+            setup.run.parking = value;
+        }
+        else if (key == "regen" && isNumber && number >= 0.0 && number <= 1.0) {
+            setup.run.energy = ElevatorEnergyModel::Regenerative(number);
+        }
+        else if (key == "bank" && isNumber && number >= 1.0) {
+            setup.numCars = (int)number;
+        }
+        else {
+            error = "bad setting: " + item;
+            return false;
+        }
+    }
+    return true;
+}
+
+// RunOnce helper function, one run of a scenario; returns the hash of its results
+static uint64_t RunOnce(const ElevatorTrace& trace, const ElevatorGoldenSetup& setup) {
+    if (setup.numCars > 0) {
+        ElevatorBankOptions bank;
+        bank.numCars = setup.numCars;
+        bank.dispatch = "collective";   // destination dispatch has a time budget, so it isn't repeatable
+        bank.strategy = setup.run.strategy;
+        ElevatorBankReport report = RunBank(trace, bank, setup.run.energy);
+        uint64_t hash = HashReport(14695981039346656037ULL, report.total);
+        for (size_t car = 0; car < report.cars.size(); ++car) {
+            hash = HashValue(HashReport(hash, report.cars[car]), report.numAssigned[car]);
+        }
+        return hash;
+    }
+
+    ECElevatorSim simulator(trace.numFloors, trace.requests, ElevatorStrategyRegistry::Instance().Create(setup.run.strategy));
+    simulator.SetParkingStrategy(CreateParkingStrategy(setup.run.parking, trace.numFloors, setup.run.parkingParams));
+    simulator.SetRetainResults(true);   // the hash reads every arrive time
+    for (int t = 0; t < trace.lenSim; ++t) {
+        simulator.Simulate(t);
+    }
+    return HashReport(HashArriveTimes(simulator, (int)trace.requests.size()), BuildRunReport(simulator, setup.run.energy));
+}
+
+// TimeReference helper function, ms taken by a fixed piece of work (table updates
+// and heap operations, like a simulation step); scenario times are divided by it,
+// so a machine that is slower, or busier, as a whole doesn't change the result
+static double TimeReference() {
+    typedef std::chrono::steady_clock Clock;
+    auto start = Clock::now();
+    std::vector<uint32_t> table(16384, 0);
+    std::vector<uint32_t> heap;
+    uint32_t x = 2463534242u;
+    for (int i = 0; i < 200000; ++i) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        table[x & 16383] += i;
+        heap.push_back(x);
+        std::push_heap(heap.begin(), heap.end());
+        if (heap.size() > 256) {
+            std::pop_heap(heap.begin(), heap.end());
+            heap.pop_back();
+        }
+    }
+    volatile uint32_t sink = table[x & 16383] + (heap.empty() ? 0 : heap.front());
+    (void)sink;
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Times a scenario: runs are grouped into batches of at least 10 ms, so even tiny
+// scenarios are measured well above the timer resolution, and every batch is
+// followed by the reference work. The fastest batch and the fastest reference
+// (the ones least disturbed by the rest of the machine) give the time of one run
+// and its cost. Memory growth is that of the first run. Every run has to give the same hash
+static void RunScenario(const ElevatorTrace& trace, const ElevatorGoldenSetup& setup, ElevatorGoldenEntry& measured,
+    bool& deterministic) {
+    const int NUM_BATCHES = 11;
+    const double MIN_BATCH_MS = 10.0;
+    const int MAX_RUNS_PER_BATCH = 10000;
+    typedef std::chrono::steady_clock Clock;
+
+    long rssBefore = GetCurrentRssKb();
+    ResetPeakRss();
+
+    auto start = Clock::now();
+    measured.hash = RunOnce(trace, setup);
+    double firstMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    measured.rssGrowthKb = std::max(0L, GetPeakRssKb() - rssBefore);
+    int runsPerBatch = (int)std::min<double>(MAX_RUNS_PER_BATCH, std::ceil(MIN_BATCH_MS / std::max(firstMs, 1e-3)));
+
+    deterministic = true;
+    std::vector<double> runMs, costs;
+    for (int batch = 0; batch < NUM_BATCHES; ++batch) {
+        double before = TimeReference();
+        start = Clock::now();
+        for (int run = 0; run < runsPerBatch; ++run) {
+            deterministic = RunOnce(trace, setup) == measured.hash && deterministic;
+        }
+        runMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count() / runsPerBatch);
+        costs.push_back(runMs.back() * 2.0 / (before + TimeReference()));
+    }
+    std::nth_element(costs.begin(), costs.begin() + NUM_BATCHES / 2, costs.end());
+    measured.wallMs = *std::min_element(runMs.begin(), runMs.end());
+    measured.cost = costs[NUM_BATCHES / 2];
+    measured.hasValues = true;
+}
+
+int RunGoldenCheck(const std::string& goldenPath, const ElevatorGoldenOptions& options, std::ostream& out) {
+    std::vector<ElevatorGoldenEntry> entries;
+    if (!LoadGoldenFile(goldenPath, entries)) {
+        out << "Couldn't read golden file: " << goldenPath << std::endl;
+        return -1;
+    }
+
+    std::string dir;
+    size_t slash = goldenPath.find_last_of("/\\");
+    if (slash != std::string::npos) {
+        dir = goldenPath.substr(0, slash + 1);
+    }
+
+    out << std::left << std::setw(24) << "Scenario" << std::setw(44) << "Setup" << std::setw(10) << "Result"
+        << std::right << std::setw(12) << "Wall ms" << std::setw(12) << "Cost" << std::setw(12) << "Golden"
+        << std::setw(12) << "RSS +kb" << std::setw(12) << "Golden kb" << "\n";
+
+    int failures = 0;
+    for (auto& entry : entries) {
+        std::string path = (entry.scenario[0] == '/' || dir.empty()) ? entry.scenario : dir + entry.scenario;
+        ElevatorTrace trace;
+        if (!LoadElevatorTrace(path, trace)) {
+            out << "Couldn't open scenario: " << path << std::endl;
+            return -1;
+        }
+        ElevatorGoldenSetup setup;
+        std::string error;
+        if (!ParseSetup(entry.strategy, setup, error)) {
+            out << "Bad scenario setup: " << entry.strategy << " (" << error << ")" << std::endl;
+            return -1;
+        }
+
+        ElevatorGoldenEntry measured = entry;
+        bool deterministic;
+        RunScenario(trace, setup, measured, deterministic);
+
+        //a scenario that looks slower is measured again (up to twice); a real slowdown shows every time
+        double limit = entry.cost * (1.0 + options.tolerance);
+        for (int retry = 0; retry < 2 && entry.hasValues && !options.update && deterministic && measured.hash == entry.hash && measured.cost > limit; retry++) {
+            ElevatorGoldenEntry again = measured;
+            RunScenario(trace, setup, again, deterministic);
+            measured.cost = std::min(measured.cost, again.cost);
+            measured.wallMs = std::min(measured.wallMs, again.wallMs);
+        }
+
+        std::string result = "ok";
+        if (!deterministic) {
+            result = "UNSTABLE";   // repeated runs disagree
+        }
+        else if (options.update) {
+            result = "updated";
+        }
+        else if (!entry.hasValues) {
+            result = "NO GOLDEN";
+        }
+        else if (measured.hash != entry.hash) {
+            result = "CHANGED";
+        }
+        else if (measured.cost > limit) {
+            result = "SLOWER";
+        }
+        else if (measured.rssGrowthKb > (long)(entry.rssGrowthKb * (1.0 + options.tolerance)) + options.slackRssKb) {
+            result = "MEMORY";
+        }
+        bool failed = result != "ok" && result != "updated";
+        failures += failed ? 1 : 0;
+
+        out << std::left << std::setw(24) << entry.scenario << std::setw(44) << entry.strategy << std::setw(10) << result
+            << std::right << std::fixed << std::setprecision(3) << std::setw(12) << measured.wallMs
+            << std::setprecision(5) << std::setw(12) << measured.cost;
+        if (entry.hasValues) {
+            out << std::setw(12) << entry.cost << std::setw(12) << measured.rssGrowthKb << std::setw(12) << entry.rssGrowthKb;
+        }
+        else {
+            out << std::setw(12) << "-" << std::setw(12) << measured.rssGrowthKb << std::setw(12) << "-";
+        }
+        out << "\n";
+
+        if (options.update && deterministic) {
+            entry = measured;
+        }
+    }
+
+    if (options.update) {
+        if (!WriteGoldenFile(goldenPath, entries)) {
+            out << "Couldn't write golden file: " << goldenPath << std::endl;
+            return -1;
+        }
+        out << "Golden file updated: " << goldenPath << std::endl;
+    }
+    else {
+        out << (failures == 0 ? "All scenarios match" : std::to_string(failures) + " scenario(s) failed") << std::endl;
+    }
+    return failures;
+}
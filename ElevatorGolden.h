@@ -0,0 +1,54 @@
+#pragma once
+#ifndef ElevatorGolden_h
+#define ElevatorGolden_h
+
+#include "ECElevatorSim.h"
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//*****************************************************************************
+// Golden-trace regression check: every scenario is run headless and the hash of
+// its results is compared with the recorded one: the final arrive times (all
+// requests, in input order, -1 if never serviced), the motion counters and the
+// energy. The cost of a run (its time relative to a fixed reference work timed
+// alongside, so it carries over between machines and loads) and its memory
+// growth are recorded too and gated against the golden values with a tolerance.
+//
+// Golden file, one scenario per line ('#' comments):
+//   <input-file> <setup> [<hash> <cost> <rss-growth-kb>]
+// setup is a strategy name, optionally followed by comma-separated settings:
+//   parking=<policy>, regen=<efficiency>, bank=<cars> (collective dispatch)
+// e.g. "look,parking=predictive,regen=0.35". Input files are relative to the
+// golden file. A line without values is a new scenario; --update-golden fills it in
+
+struct ElevatorGoldenEntry
+{
+    std::string scenario;
+    std::string strategy;      // the setup, as written
+    bool hasValues = false;
+    uint64_t hash = 0;
+    double cost = 0.0;         // time of one run / time of a fixed reference work (the gated value)
+    double wallMs = 0.0;       // time of one run (measured only, not recorded)
+    long rssGrowthKb = 0;      // resident memory added while running the scenario
+};
+
+struct ElevatorGoldenOptions
+{
+    bool update = false;           // record new golden values instead of checking
+    double tolerance = 0.25;       // allowed relative cost / memory growth
+    long slackRssKb = 256;         // plus this much memory (allocator and page granularity)
+};
+
+// Hash of the arrive times of requests 0 .. numRequests-1 (FNV-1a)
+uint64_t HashArriveTimes(const ECElevatorSim& sim, int numRequests);
+
+bool LoadGoldenFile(const std::string& path, std::vector<ElevatorGoldenEntry>& entries);
+bool WriteGoldenFile(const std::string& path, const std::vector<ElevatorGoldenEntry>& entries);
+
+// Check (or update) every scenario of the golden file; returns the number of failures
+// (-1 if the golden file or a scenario can't be read)
+int RunGoldenCheck(const std::string& goldenPath, const ElevatorGoldenOptions& options, std::ostream& out);
+
+#endif
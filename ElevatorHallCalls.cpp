@@ -0,0 +1,92 @@
+#include "ElevatorHallCalls.h"
+#include <algorithm>
+
+// ElevatorHallCalls Implementation
+ElevatorHallCalls::ElevatorHallCalls(int numFloorsIn)
+    : numFloors(numFloorsIn < 1 ? 1 : numFloorsIn), numCalls(0),
+      waitingUp(numFloors + 1), waitingDown(numFloors + 1), riders(numFloors + 1) {
+}
+
+// insert helper method, keeps a group in handle order (requests mostly arrive in order)
+void ElevatorHallCalls::insert(std::vector<ElevatorRequestHandle>& group, ElevatorRequestHandle handle) {
+    if (group.empty() || group.back() < handle) {
+        group.push_back(handle);
+    }
+    else {
+        group.insert(std::upper_bound(group.begin(), group.end(), handle), handle);
+    }
+}
+
+bool ElevatorHallCalls::erase(std::vector<ElevatorRequestHandle>& group, ElevatorRequestHandle handle) {
+    auto it = std::lower_bound(group.begin(), group.end(), handle);
+    if (it == group.end() || *it != handle) {
+        return false;
+    }
+    group.erase(it);
+    return true;
+}
+
+void ElevatorHallCalls::AddWaiting(ElevatorRequestHandle handle, int floorSrc, int floorDest) {
+    if (!inRange(floorSrc)) return;
+
+    std::vector<ElevatorRequestHandle>& group = waitingGroup(floorSrc, floorDest > floorSrc);
+    if (group.empty()) numCalls++;
+    insert(group, handle);
+}
+
+void ElevatorHallCalls::Board(ElevatorRequestHandle handle, int floorSrc, int floorDest) {
+    if (inRange(floorSrc)) {
+        std::vector<ElevatorRequestHandle>& group = waitingGroup(floorSrc, floorDest > floorSrc);
+        if (erase(group, handle) && group.empty()) numCalls--;
+    }
+    if (inRange(floorDest)) {
+        insert(riders[floorDest], handle);
+    }
+}
+
+void ElevatorHallCalls::Alight(ElevatorRequestHandle handle, int floorDest) {
+    if (inRange(floorDest)) {
+        erase(riders[floorDest], handle);
+    }
+}
+
+void ElevatorHallCalls::Withdraw(ElevatorRequestHandle handle, int floorSrc, int floorDest) {
+    if (!inRange(floorSrc)) return;
+
+    std::vector<ElevatorRequestHandle>& group = waitingGroup(floorSrc, floorDest > floorSrc);
+    if (erase(group, handle) && group.empty()) numCalls--;
+}
+
+const std::vector<ElevatorRequestHandle>& ElevatorHallCalls::GetWaiting(int floor, bool up) const {
+    if (!inRange(floor)) return empty;
+    return up ? waitingUp[floor] : waitingDown[floor];
+}
+
+const std::vector<ElevatorRequestHandle>& ElevatorHallCalls::GetRiders(int floor) const {
+    return inRange(floor) ? riders[floor] : empty;
+}
+
+void ElevatorHallCalls::TakeWaiting(int floor, bool up, std::vector<ElevatorRequestHandle>& group) {
+    group.clear();
+    if (!inRange(floor)) return;
+
+    std::vector<ElevatorRequestHandle>& taken = waitingGroup(floor, up);
+    if (!taken.empty()) numCalls--;
+    group.swap(taken);
+}
+
+void ElevatorHallCalls::PutBackWaiting(int floor, bool up, const std::vector<ElevatorRequestHandle>& group) {
+    if (!inRange(floor) || group.empty()) return;
+
+    std::vector<ElevatorRequestHandle>& target = waitingGroup(floor, up);
+    if (target.empty()) numCalls++;
+    for (ElevatorRequestHandle handle : group) {
+        insert(target, handle);
+    }
+}
+
+void ElevatorHallCalls::TakeRiders(int floor, std::vector<ElevatorRequestHandle>& group) {
+    group.clear();
+    if (!inRange(floor)) return;
+    group.swap(riders[floor]);
+}
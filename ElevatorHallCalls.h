@@ -0,0 +1,55 @@
+#pragma once
+#ifndef ElevatorHallCalls_h
+#define ElevatorHallCalls_h
+
+#include "ECElevatorSim.h"
+#include <vector>
+
+//*****************************************************************************
+// Hall calls grouped per floor and direction: everyone waiting at a floor to go
+// up is one group, everyone going down another, and the riders of the cabin are
+// grouped by destination. Each group lists its requests in handle order (the
+// order the simulator serves them in), so a stop touches only the passengers at
+// that floor and a whole group boards or alights in one pass.
+//
+// Groups cover requests whose floor is inside the building; the simulator only
+// relies on them while ElevatorFloorDemand::IsExact()
+
+class ElevatorHallCalls
+{
+public:
+    explicit ElevatorHallCalls(int numFloors = 1);
+
+    // A passenger starts waiting / boards / alights (boarding and alighting drop
+    // the request from its group if it is still listed there)
+    void AddWaiting(ElevatorRequestHandle handle, int floorSrc, int floorDest);
+    void Board(ElevatorRequestHandle handle, int floorSrc, int floorDest);
+    void Alight(ElevatorRequestHandle handle, int floorDest);
+    void Withdraw(ElevatorRequestHandle handle, int floorSrc, int floorDest);   // leaves without boarding
+
+    // Waiting at floor to go up (or down); riders going to floor
+    const std::vector<ElevatorRequestHandle>& GetWaiting(int floor, bool up) const;
+    const std::vector<ElevatorRequestHandle>& GetRiders(int floor) const;
+
+    // Batch operations: take a whole group out (it is empty afterwards), and put
+    // back the part of a taken group that stayed (still in handle order)
+    void TakeWaiting(int floor, bool up, std::vector<ElevatorRequestHandle>& group);
+    void PutBackWaiting(int floor, bool up, const std::vector<ElevatorRequestHandle>& group);
+    void TakeRiders(int floor, std::vector<ElevatorRequestHandle>& group);
+
+    // Number of distinct hall calls (non-empty up/down groups)
+    int GetNumCalls() const { return numCalls; }
+
+private:
+    bool inRange(int floor) const { return floor >= 1 && floor <= numFloors; }
+    std::vector<ElevatorRequestHandle>& waitingGroup(int floor, bool up) { return up ? waitingUp[floor] : waitingDown[floor]; }
+    void insert(std::vector<ElevatorRequestHandle>& group, ElevatorRequestHandle handle);
+    bool erase(std::vector<ElevatorRequestHandle>& group, ElevatorRequestHandle handle);
+
+    int numFloors;
+    int numCalls;
+    std::vector<std::vector<ElevatorRequestHandle>> waitingUp, waitingDown, riders;   // by floor
+    std::vector<ElevatorRequestHandle> empty;
+};
+
+#endif
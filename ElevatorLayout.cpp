@@ -0,0 +1,28 @@
+#include "ElevatorLayout.h"
+#include <string>
+
+void ElevatorLayout::DrawPassenger(ECGraphicViewImp& view, int x, int y, int destFloor) {
+	// Head
+	view.DrawFilledCircle(x, y - 15, 7, ECGV_WHITE);
+	view.DrawCircle(x, y - 15, 7, 2, ECGV_BLACK);
+
+	// Body
+	view.DrawFilledRectangle(
+		x - 7,
+		y - 8,
+		x + 7,
+		y + 20,
+		ECGV_WHITE
+	);
+	view.DrawRectangle(
+		x - 7,
+		y - 8,
+		x + 7,
+		y + 20,
+		2,
+		ECGV_BLACK
+	);
+
+	// draw the passengers destination floor on them
+	view.DrawText(x, y + 5, std::to_string(destFloor).c_str(), ECGV_BLACK);
+}
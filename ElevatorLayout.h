@@ -0,0 +1,18 @@
+#pragma once
+#ifndef ElevatorLayout_h
+#define ElevatorLayout_h
+
+#include "ECGraphicViewImp.h"
+
+//shared layout of the elevator views (live and replay)
+namespace ElevatorLayout {
+	const int ELEVATOR_X = 50;   //position of Elevator from left
+	const int ELEVATOR_Y = 50;   //position of Elevator from top
+	const int ELEVATOR_W = 200;  //width of Elevator shaft
+	const int FLOOR_HEIGHT = 70;  //height of each floor
+
+	//draws a passenger labeled with their destination floor
+	void DrawPassenger(ECGraphicViewImp& view, int x, int y, int destFloor);
+}
+
+#endif
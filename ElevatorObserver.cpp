@@ -1,48 +1,87 @@
 #include "ElevatorObserver.h"
 #include "ECElevatorSim.h"
+#include "ElevatorLayout.h"
+#include "ElevatorHallCalls.h"
+#include "ECProfiler.h"
 #include <string>
+#include <algorithm>
+#include <cstdio>
 
-namespace {
-	const int ELEVATOR_X = 50;   //position of Elevator from left
-	const int ELEVATOR_Y = 50;   //position of Elevator from top
-	const int ELEVATOR_W = 200;  //width of Elevator shaft
-	const int FLOOR_HEIGHT = 70;  //height of each floor
-}
+using namespace ElevatorLayout;
+
+//steps per FRAMES_PER_STEP frames for keys 1-4 (0 = as fast as the frame budget allows)
+static const int SPEEDS[] = { 1, 10, 100, 0 };
+static const int NUM_SPEEDS = sizeof(SPEEDS) / sizeof(SPEEDS[0]);
 
 
 //Constructor (now updated with newly implemented variables for part 3)
 ElevatorObserver::ElevatorObserver(ECGraphicViewImp& displayManager, ECElevatorSim& simulator, int timeToSim) : displayManager(displayManager),
 	simulatorRef(simulator),
+	riderTracker(simulator),
 	simTimeLength(timeToSim),
 	currTime(0),
 	isPaused(false),
+	speedIndex(0),
+	stepCredit(0),
+	enteringTime(false),
+	skipTarget(-1),
 	floorCount(simulator.GetNumFloors()),  //dynamically takes in floor count
 	currPos(0),
 	positionOffset(0.0),
-	headCount(0)
+	headCount(0),
+	showMetrics(false),
+	framesInWindow(0),
+	stepsInWindow(0),
+	fps(0.0),
+	stepsPerSec(0.0),
+	frameTimeMs(0.0),
+	renderTimeMs(0.0)
 	{
+		lastFrame = rateWindowStart = std::chrono::steady_clock::now();
 		queue.resize(floorCount, std::make_pair(0, 0));
 	}
 
 
+//Rider tracker: subscribes to the simulator for as long as it lives
+ElevatorRiderTracker::ElevatorRiderTracker(ECElevatorSim& simulator) : simulatorRef(simulator) {
+	simulatorRef.Attach(this);
+}
+
+ElevatorRiderTracker::~ElevatorRiderTracker() {
+	simulatorRef.Detach(this);
+}
+
+void ElevatorRiderTracker::Update() {
+	const ElevatorEventRecord& ev = simulatorRef.GetCurrEvent();
+	std::pair<ElevatorRequestHandle, int> rider(ev.request, ev.type == EC_SIM_EV_BOARDED ? ev.aux : ev.floor);
+	auto it = std::lower_bound(riders.begin(), riders.end(), rider);
+	if (ev.type == EC_SIM_EV_BOARDED) {
+		riders.insert(it, rider);
+	}
+	else if (it != riders.end() && it->first == ev.request) {
+		riders.erase(it);
+	}
+}
+
+
 //Updates the Window displaying the output
 void ElevatorObserver::Update() {
 	ECGVEventType currentEvent = displayManager.GetCurrEvent();
 
-	static int frameCount = 0;
-	if (currentEvent == ECGV_EV_TIMER && !isPaused && currTime < simTimeLength) {
-		frameCount++;
+	if (currentEvent == ECGV_EV_TIMER && ((!isPaused && currTime < simTimeLength) || enteringTime)) {
+		auto frameStart = std::chrono::steady_clock::now();
+		UpdateFrameRates(frameStart);
 
-		if (frameCount >= 85) {
-			simulatorRef.Simulate(currTime);
-			currPos = simulatorRef.GetCurrFloor();
-			currTime++;
-			frameCount = 0;
+		if (!isPaused) {
+			AdvanceSimulation(frameStart);
 		}
 
-		// Smooth movement 
+		// Smooth movement (above 1x the car moves faster than it can be animated, so it is drawn where it is)
 		double targetPos = std::max(0, currPos - 1);
-		if (abs(positionOffset - targetPos) > 0.02) {
+		if (GetSpeed() != 1) {
+			positionOffset = targetPos;
+		}
+		else if (abs(positionOffset - targetPos) > 0.02) {
 			if (positionOffset < targetPos) {
 				positionOffset += 0.02;
 			}
@@ -52,44 +91,31 @@ void ElevatorObserver::Update() {
 		}
 
 		// Update display
-		RenderShaft();
-		RenderElevator();
-		RenderFloors();
-
-		std::string displayTime = "Time: " + std::to_string(currTime);
-		displayManager.DrawText(ELEVATOR_X + ELEVATOR_W + 140, 90, displayTime.c_str(), ECGV_BLACK);
+		{
+			EC_PROFILE_SCOPE(EC_PHASE_OBSERVER_RENDER);
+			RenderShaft();
+			RenderElevator();
+			RenderFloors();
+
+			std::string displayTime = "Time: " + std::to_string(currTime);
+			displayManager.DrawText(ELEVATOR_X + ELEVATOR_W + 140, 90, displayTime.c_str(), ECGV_BLACK);
+			RenderSpeed();
+
+			if (showMetrics) {
+				RenderMetrics();
+			}
+		}
+		renderTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
 
 		displayManager.SetRedraw(true);
 	}
 
-	ProcessInputs();
+	ProcessInputs(currentEvent);
 }
 
 //method for drawing the passengers, whether waiting or in the elevator cabin
 void ElevatorObserver::DrawPassenger(int x, int y, int destFloor) {
-	// Head
-	displayManager.DrawFilledCircle(x, y - 15, 7, ECGV_WHITE);
-	displayManager.DrawCircle(x, y - 15, 7, 2, ECGV_BLACK);
-
-	// Body
-	displayManager.DrawFilledRectangle(
-		x - 7,
-		y - 8,
-		x + 7,
-		y + 20,
-		ECGV_WHITE
-	);
-	displayManager.DrawRectangle(
-		x - 7,
-		y - 8,
-		x + 7,
-		y + 20,
-		2,
-		ECGV_BLACK
-	);
-
-	// draw the passengers destination floor on them
-	displayManager.DrawText(x, y + 5, std::to_string(destFloor).c_str(), ECGV_BLACK);
+	ElevatorLayout::DrawPassenger(displayManager, x, y, destFloor);
 }
 
 void ElevatorObserver::RenderShaft() {
@@ -143,17 +169,11 @@ void ElevatorObserver::RenderElevator() {
 		if (i < floorCount) {
 			int indicatorY = currHeight - FLOOR_HEIGHT / 2; //middle of floor
 
-			// Set button states based on requests
-			for (const auto& req : simulatorRef.GetRequests()) {
-				if (!req.IsFloorRequestDone() && req.GetTime() <= currTime && (req.GetFloorSrc() == i + 1)) {
-					if (req.GetFloorDest() > req.GetFloorSrc()) {
-						queue[i].first = 1;  // Up button
-					}
-					else {
-						queue[i].second = 1;  // Down button
-					}
-				}
-			}
+			// Set button states based on the hall calls of this floor
+			const std::vector<ElevatorRequestHandle>& callUp = simulatorRef.GetHallCalls().GetWaiting(i + 1, true);
+			const std::vector<ElevatorRequestHandle>& callDown = simulatorRef.GetHallCalls().GetWaiting(i + 1, false);
+			queue[i].first = callUp.empty() ? 0 : 1;     // Up button
+			queue[i].second = callDown.empty() ? 0 : 1;  // Down button
 
 			// Up indicator
 			if (queue[i].first) {
@@ -197,15 +217,17 @@ void ElevatorObserver::RenderElevator() {
 			int totalPassengers = queue[i].first + queue[i].second;  // Total on this floor
 			int drawnCount = 0;  // Keep track of passengers drawn
 
-			// Draw all passengers with their destination floors
-			for (const auto& request : simulatorRef.GetRequests()) {
-				if (!request.IsFloorRequestDone() && request.GetFloorSrc() == i+1 && request.GetTime() <= currTime) {
-					int floorY = bottomBoundary - ((request.GetFloorSrc() - 1) * FLOOR_HEIGHT) - FLOOR_HEIGHT / 2;
-					DrawPassenger(rightBoundary + 45 + (drawnCount * 20),
-						floorY, 
-						request.GetFloorDest());
-					drawnCount++;
-				}
+			// Draw all passengers with their destination floors (both calls merged, in request order)
+			int floorY = bottomBoundary - (i * FLOOR_HEIGHT) - FLOOR_HEIGHT / 2;
+			size_t up = 0, down = 0;
+			while (up < callUp.size() || down < callDown.size()) {
+				bool takeUp = down == callDown.size() || (up < callUp.size() && callUp[up] < callDown[down]);
+				ElevatorRequestResult request;
+				simulatorRef.GetResult(takeUp ? callUp[up++] : callDown[down++], request);
+				DrawPassenger(rightBoundary + 45 + (drawnCount * 20),
+					floorY, 
+					request.floorDest);
+				drawnCount++;
 			}
 		}
 	}
@@ -225,7 +247,7 @@ void ElevatorObserver::RenderFloors() {
 		position - FLOOR_HEIGHT + 5,
 		ELEVATOR_X + ELEVATOR_W - marginSize,
 		position,
-		ECGV_CYAN
+		simulatorRef.IsInMaintenance() ? ECGV_RED : ECGV_CYAN  //red while out of service
 	);
 
 	//draw passengers 
@@ -234,24 +256,174 @@ void ElevatorObserver::RenderFloors() {
 	int drawnCount = 0;
 
 	// Draw passengers in elevator with their destinations
-	for (const auto& request : simulatorRef.GetRequests()) {
-		if (request.IsFloorRequestDone() && !request.IsServiced()) {
-			int passengerX = ELEVATOR_X + marginSize + (sectionWidth * drawnCount) + (sectionWidth / 2);
-			int passengerY = position - FLOOR_HEIGHT / 2;
-			DrawPassenger(passengerX, passengerY, request.GetFloorDest());
-			drawnCount++;
-		}
+	for (const auto& rider : riderTracker.GetRiders()) {
+		int passengerX = ELEVATOR_X + marginSize + (sectionWidth * drawnCount) + (sectionWidth / 2);
+		int passengerY = position - FLOOR_HEIGHT / 2;
+		DrawPassenger(passengerX, passengerY, rider.second);
+		drawnCount++;
 	}
 }
 
 //for processing key and mouse inputs
-void ElevatorObserver::ProcessInputs() {
-	ECGVEventType currentEvent = displayManager.GetCurrEvent();
+void ElevatorObserver::ProcessInputs(ECGVEventType currentEvent) {
+	// Typing a time to skip to: digits, backspace, Enter to go, Escape to cancel
+	if (enteringTime) {
+		if (currentEvent >= ECGV_EV_KEY_DOWN_0 && currentEvent <= ECGV_EV_KEY_DOWN_9 && timeEntry.size() < 9) {
+			timeEntry += (char)('0' + (currentEvent - ECGV_EV_KEY_DOWN_0));
+		}
+		else if (currentEvent == ECGV_EV_KEY_DOWN_BACKSPACE && !timeEntry.empty()) {
+			timeEntry.pop_back();
+		}
+		else if (currentEvent == ECGV_EV_KEY_DOWN_ENTER) {
+			enteringTime = false;
+			int target = timeEntry.empty() ? -1 : std::min(std::stoi(timeEntry), simTimeLength);
+			if (target > currTime) {
+				skipTarget = target;
+				isPaused = false;
+			}
+		}
+		else if (currentEvent == ECGV_EV_KEY_DOWN_ESCAPE) {
+			enteringTime = false;
+		}
+		return;
+	}
+
+	// G to skip ahead to a time
+	if (currentEvent == ECGV_EV_KEY_DOWN_G) {
+		enteringTime = true;
+		timeEntry.clear();
+	}
+
+	// 1-4 for 1x, 10x, 100x and max speed
+	if (currentEvent >= ECGV_EV_KEY_DOWN_1 && currentEvent < ECGV_EV_KEY_DOWN_1 + NUM_SPEEDS) {
+		speedIndex = currentEvent - ECGV_EV_KEY_DOWN_1;
+		stepCredit = 0;
+	}
 
 	// Space bar for pause/resume
 	if (currentEvent == ECGV_EV_KEY_DOWN_SPACE) {
 		isPaused = !isPaused;
 		std::cout << "Pause state: " << isPaused << std::endl;
 	}
+
+	// D for the metrics panel
+	if (currentEvent == ECGV_EV_KEY_DOWN_D) {
+		showMetrics = !showMetrics;
+	}
 }
 
+bool ElevatorObserver::SetSpeed(int speed) {
+	for (int i = 0; i < NUM_SPEEDS; i++) {
+		if (SPEEDS[i] == speed && speed > 0) {
+			speedIndex = i;
+			stepCredit = 0;
+			return true;
+		}
+	}
+	return false;
+}
+
+//speed in steps per FRAMES_PER_STEP frames, 0 for max (skipping always runs at max)
+int ElevatorObserver::GetSpeed() const {
+	return skipTarget > currTime ? 0 : SPEEDS[speedIndex];
+}
+
+void ElevatorObserver::SimulateStep() {
+	EC_PROFILE_SCOPE(EC_PHASE_OBSERVER_SIMULATE);
+	simulatorRef.Simulate(currTime);
+	currTime++;
+	stepsInWindow++;
+}
+
+//runs the steps due this frame; at max speed as many as fit in MAX_SPEED_BUDGET_MS,
+//so the window keeps up with the timer and only the latest state is drawn
+void ElevatorObserver::AdvanceSimulation(std::chrono::steady_clock::time_point frameStart) {
+	int speed = GetSpeed();
+	int limit = (skipTarget > currTime) ? skipTarget : simTimeLength;
+
+	if (speed > 0) {
+		stepCredit += speed;
+		while (stepCredit >= FRAMES_PER_STEP && currTime < limit) {
+			SimulateStep();
+			stepCredit -= FRAMES_PER_STEP;
+		}
+	}
+	else {
+		auto deadline = frameStart + std::chrono::milliseconds(MAX_SPEED_BUDGET_MS);
+		while (currTime < limit) {
+			//check the clock every few steps, steps are much shorter than a frame
+			for (int i = 0; i < 16 && currTime < limit; i++) {
+				SimulateStep();
+			}
+			if (std::chrono::steady_clock::now() >= deadline) break;
+		}
+	}
+	currPos = simulatorRef.GetCurrFloor();
+
+	if (skipTarget != -1 && currTime >= skipTarget) {
+		skipTarget = -1;   //arrived, back to the selected speed
+		stepCredit = 0;
+	}
+}
+
+//speed or skip status above the timer, or the time being typed
+void ElevatorObserver::RenderSpeed() {
+	std::string status;
+	if (enteringTime) {
+		status = "Go to time: " + timeEntry + "_";
+	}
+	else if (skipTarget > currTime) {
+		status = "Skipping to " + std::to_string(skipTarget);
+	}
+	else {
+		int speed = SPEEDS[speedIndex];
+		status = "Speed: " + (speed > 0 ? std::to_string(speed) + "x" : std::string("max"));
+	}
+	displayManager.DrawText(ELEVATOR_X + ELEVATOR_W + 140, 60, status.c_str(), ECGV_BLACK);
+}
+
+//frame time of every frame, fps and simulation steps/sec over one second windows
+void ElevatorObserver::UpdateFrameRates(std::chrono::steady_clock::time_point now) {
+	frameTimeMs = std::chrono::duration<double, std::milli>(now - lastFrame).count();
+	lastFrame = now;
+	framesInWindow++;
+
+	double windowSec = std::chrono::duration<double>(now - rateWindowStart).count();
+	if (windowSec >= 1.0) {
+		fps = framesInWindow / windowSec;
+		stepsPerSec = stepsInWindow / windowSec;
+		framesInWindow = 0;
+		stepsInWindow = 0;
+		rateWindowStart = now;
+	}
+}
+
+//draws the metrics panel under the timer (all values come from counters, nothing is rescanned)
+void ElevatorObserver::RenderMetrics() {
+	const ElevatorLiveStats& stats = simulatorRef.GetLiveStats();
+	int panelX = ELEVATOR_X + ELEVATOR_W + 140;  //center of the panel, same as the timer
+	int panelY = 120;
+	const int lineHeight = 24;
+
+	const int numLines = 9;
+	char lines[numLines][32];
+	snprintf(lines[0], sizeof(lines[0]), "Last wait: %d", std::max(0, stats.lastWait));
+	snprintf(lines[1], sizeof(lines[1]), "Rolling avg: %.1f", stats.GetRollingAverageWait());  //last ROLLING_WINDOW completions
+	snprintf(lines[2], sizeof(lines[2]), "Avg wait: %.1f", stats.GetAverageWait());
+	snprintf(lines[3], sizeof(lines[3]), "Riders: %d", stats.numRiding);
+	snprintf(lines[4], sizeof(lines[4]), "Waiting: %d", stats.numWaiting);
+	snprintf(lines[5], sizeof(lines[5]), "Steps/s: %.2f", stepsPerSec);
+	snprintf(lines[6], sizeof(lines[6]), "FPS: %.1f", fps);
+	snprintf(lines[7], sizeof(lines[7]), "Frame: %.1f ms", frameTimeMs);
+	snprintf(lines[8], sizeof(lines[8]), "Draw: %.2f ms", renderTimeMs);
+
+	int left = panelX - 110, right = panelX + 110;
+	int bottom = panelY + numLines * lineHeight + 4;
+	displayManager.DrawFilledRectangle(left, panelY - 6, right, bottom, ECGV_WHITE);
+	displayManager.DrawRectangle(left, panelY - 6, right, bottom, 2, ECGV_BLACK);
+	for (int i = 0; i < numLines; i++) {
+		displayManager.DrawText(panelX, panelY + i * lineHeight, lines[i], ECGV_BLACK);
+	}
+}
+
+
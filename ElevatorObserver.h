@@ -7,32 +7,80 @@
 #include "ECElevatorSim.h"
 #include <vector>
 #include <utility>
+#include <chrono>
+#include <string>
+
+//The riders of the cabin in request order, kept up to date from the boarded/alighted
+//events of the simulator instead of rescanning its requests every frame
+class ElevatorRiderTracker : public ECObserver {
+public:
+	explicit ElevatorRiderTracker(ECElevatorSim& simulator);
+	~ElevatorRiderTracker();
+	virtual void Update();
+	virtual ECEventMask GetEventMask() const { return ECEventBit(EC_SIM_EV_BOARDED) | ECEventBit(EC_SIM_EV_ALIGHTED); }
+
+	//(handle, destination floor) of every rider
+	const std::vector<std::pair<ElevatorRequestHandle, int>>& GetRiders() const { return riders; }
+
+private:
+	ECElevatorSim& simulatorRef;
+	std::vector<std::pair<ElevatorRequestHandle, int>> riders;
+};
 
 class ElevatorObserver : public ECObserver {
 public:
 	ElevatorObserver(ECGraphicViewImp& displayManager, ECElevatorSim& simulator, int timeToSim);  //includes simulator and simulation time now
 	virtual void Update();
+	virtual ECEventMask GetEventMask() const { return ECGV_MASK_TIMER | ECGV_MASK_KEY_DOWN; }  //frames and keys only
+
+	//steps per FRAMES_PER_STEP frames: 1, 10 or 100 (what keys 1-3 select); false for other values
+	bool SetSpeed(int speed);
 
 private:
 	ECGraphicViewImp& displayManager;
 	ECElevatorSim& simulatorRef;  //reference to the simulator
+	ElevatorRiderTracker riderTracker;  //who is in the cabin
 
 	//New part 3 variables
 	int simTimeLength; //total simulation time
 	int currTime;  //current simulation time
 	bool isPaused;  //used to pause/resume the simulation
 
+	//speed controls (keys 1-4) and skip to time (G, digits, Enter)
+	static const int FRAMES_PER_STEP = 85;  //frames per simulation step at 1x
+	static const int MAX_SPEED_BUDGET_MS = 10;  //simulation time per frame at max speed
+	int speedIndex;   //index into the speed table; speed 0 means max
+	int stepCredit;   //accumulated speed; a step is due every FRAMES_PER_STEP
+	bool enteringTime;   //typing the time to skip to
+	std::string timeEntry;
+	int skipTarget;   //time being skipped to, -1 if none
+
 	int floorCount;  //number of floors in the Elevator display
 	int currPos;     //current position of the Elevator
 	double positionOffset;   //used for fluid movement
 	int headCount;   //number of passengers in the Elevator
 	std::vector<std::pair<int, int>> queue;  //the passengers waiting at each floor (up and down)
 
+	//metrics panel (toggled with D)
+	bool showMetrics;
+	std::chrono::steady_clock::time_point lastFrame;   //when the previous timer frame started
+	std::chrono::steady_clock::time_point rateWindowStart;   //start of the current one second window
+	int framesInWindow, stepsInWindow;
+	double fps, stepsPerSec;
+	double frameTimeMs;   //time between frames
+	double renderTimeMs;  //time spent drawing a frame
+
 	//helper functions for drawing display
 	void RenderShaft();   //draws the shaft of the Elevator
 	void RenderElevator();  //draws the Elevator itself (moving square)
 	void RenderFloors();   //draws the floor lines to distinguish between floors
-	void ProcessInputs();  //handles the input of the user
+	void ProcessInputs(ECGVEventType currentEvent);  //handles the input of the user
+	void RenderMetrics();  //draws the metrics panel
+	void UpdateFrameRates(std::chrono::steady_clock::time_point now);
+	void AdvanceSimulation(std::chrono::steady_clock::time_point frameStart);  //runs this frame's simulation steps
+	void SimulateStep();
+	void RenderSpeed();  //draws the speed / skip status above the timer
+	int GetSpeed() const;
 	void DrawPassenger(int x, int y, int destFloor); // draws the passenger
 };
 
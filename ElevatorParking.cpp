@@ -0,0 +1,105 @@
+#include "ElevatorParking.h"
+#include <algorithm>
+#include <cmath>
+
+// Rescale the weights before exp() gets this large
+static const double MAX_EXPONENT = 50.0;
+
+// PredictiveParkingStrategy Implementation
+// Every call adds exp((time - baseTime) / tau): the same decay for all floors,
+// so the weights never have to be touched between calls
+PredictiveParkingStrategy::PredictiveParkingStrategy(int numFloorsIn, double halfLife)
+    : numFloors(std::max(1, numFloorsIn)), decayPerStep(std::log(2.0) / std::max(1.0, halfLife)),
+      weights(numFloors + 1, 0.0), baseTime(0), lastTime(0), parkFloor(-1), dirty(false) {
+}
+
+void PredictiveParkingStrategy::observeArrival(int floorSrc, int time) {
+    if (floorSrc < 1 || floorSrc > numFloors) return;
+
+    if (parkFloor == -1 && !dirty) {
+        baseTime = time;
+    }
+    double exponent = (time - baseTime) * decayPerStep;
+    if (exponent > MAX_EXPONENT) {
+        double scale = std::exp(-exponent);
+        for (double& w : weights) {
+            w *= scale;
+        }
+        baseTime = time;
+        exponent = 0.0;
+    }
+    weights[floorSrc] += std::exp(exponent);
+    lastTime = std::max(lastTime, time);
+    dirty = true;
+}
+
+int PredictiveParkingStrategy::chooseParkingFloor(const ECElevatorSim&, int) {
+    if (dirty) {
+        //weighted median: minimizes the expected distance to the next call
+        double total = 0.0;
+        for (int f = 1; f <= numFloors; ++f) {
+            total += weights[f];
+        }
+        double sum = 0.0;
+        for (int f = 1; f <= numFloors; ++f) {
+            sum += weights[f];
+            if (sum * 2.0 >= total) {
+                parkFloor = f;
+                break;
+            }
+        }
+        dirty = false;
+    }
+    return parkFloor;
+}
+
+double PredictiveParkingStrategy::GetRate(int floor) const {
+    if (floor < 1 || floor > numFloors) return 0.0;
+    //sum of exp(-(lastTime - t) / tau) over the calls, times 1 / tau for a per-step rate
+    return weights[floor] * std::exp((baseTime - lastTime) * decayPerStep) * decayPerStep;
+}
+
+// DelayedParkingStrategy Implementation
+DelayedParkingStrategy::DelayedParkingStrategy(ElevatorParkingStrategy* parkingIn, int delayIn)
+    : parking(parkingIn), delay(std::max(0, delayIn)), idleSince(0), lastAsked(-2) {
+}
+
+DelayedParkingStrategy::~DelayedParkingStrategy() {
+    delete parking;
+}
+
+int DelayedParkingStrategy::chooseParkingFloor(const ECElevatorSim& sim, int currTime) {
+    //a step without asking means the car had something to do in between
+    if (currTime > lastAsked + 1) {
+        idleSince = currTime;
+    }
+    lastAsked = currTime;
+    if (currTime - idleSince < delay) {
+        return -1;
+    }
+    return parking->chooseParkingFloor(sim, currTime);
+}
+
+ElevatorParkingStrategy* CreateParkingStrategy(const std::string& name, int numFloors, const ElevatorParkingParams& params) {
+    ElevatorParkingStrategy* parking = NULL;
+    if (name == "lobby") {
+        parking = new LobbyParkingStrategy(std::min(std::max(params.lobbyFloor, 1), std::max(numFloors, 1)));
+    }
+    else if (name == "predictive") {
+        parking = new PredictiveParkingStrategy(numFloors, params.halfLife);
+    }
+    if (parking != NULL && params.idleDelay > 0) {
+        parking = new DelayedParkingStrategy(parking, params.idleDelay);
+    }
+    return parking;
+}
+
+const std::vector<std::string>& GetParkingStrategyNames() {
+    static const std::vector<std::string> names = { "none", "lobby", "predictive" };
+    return names;
+}
+
+bool IsParkingStrategy(const std::string& name) {
+    const std::vector<std::string>& names = GetParkingStrategyNames();
+    return std::find(names.begin(), names.end(), name) != names.end();
+}
@@ -0,0 +1,87 @@
+#pragma once
+#ifndef ElevatorParking_h
+#define ElevatorParking_h
+
+#include "ECElevatorSim.h"
+#include <string>
+#include <vector>
+
+//*****************************************************************************
+// Built-in parking policies (what an idle car does)
+
+// Settings of the parking policies (the defaults are the plain policies)
+struct ElevatorParkingParams
+{
+    int lobbyFloor = 1;        // lobby: where the car goes
+    double halfLife = 200.0;   // predictive: how fast old calls are forgotten (steps)
+    int idleDelay = 0;         // any policy: steps the car stands idle before it parks
+};
+
+// Lobby: always return to the lobby (floor 1 unless set otherwise)
+class LobbyParkingStrategy : public ElevatorParkingStrategy
+{
+public:
+    explicit LobbyParkingStrategy(int floor = 1) : floor(floor) {}
+
+    const char* getName() const override { return "lobby"; }
+    void observeArrival(int, int) override {}
+    int chooseParkingFloor(const ECElevatorSim&, int) override { return floor; }
+
+private:
+    int floor;
+};
+
+// Predictive: learns the call rate of every floor during the run, with older
+// calls counting less (exponential decay, halfLife steps), and parks at the
+// floor closest on average to the next call (the weighted median of the rates).
+// Stays put until it has seen a call
+class PredictiveParkingStrategy : public ElevatorParkingStrategy
+{
+public:
+    explicit PredictiveParkingStrategy(int numFloors, double halfLife = 200.0);
+
+    const char* getName() const override { return "predictive"; }
+    void observeArrival(int floorSrc, int time) override;
+    int chooseParkingFloor(const ECElevatorSim& sim, int currTime) override;
+
+    // Decayed call rate of a floor as of the latest call (calls per step)
+    double GetRate(int floor) const;
+
+private:
+    int numFloors;
+    double decayPerStep;             // 1 / time constant
+    std::vector<double> weights;     // by floor, scaled by exp((time - baseTime) * decayPerStep)
+    int baseTime;
+    int lastTime;
+    int parkFloor;                   // weighted median, -1 until the first call
+    bool dirty;
+};
+
+// Delayed: another policy that only takes over once the car has stood idle for
+// delay steps, so a car that is called again soon after doesn't make the trip
+class DelayedParkingStrategy : public ElevatorParkingStrategy
+{
+public:
+    DelayedParkingStrategy(ElevatorParkingStrategy* parking, int delay);   // owns parking
+    ~DelayedParkingStrategy() override;
+    DelayedParkingStrategy(const DelayedParkingStrategy&) = delete;
+    DelayedParkingStrategy& operator=(const DelayedParkingStrategy&) = delete;
+
+    const char* getName() const override { return parking->getName(); }
+    void observeArrival(int floorSrc, int time) override { parking->observeArrival(floorSrc, time); }
+    int chooseParkingFloor(const ECElevatorSim& sim, int currTime) override;
+
+private:
+    ElevatorParkingStrategy* parking;
+    int delay;
+    int idleSince;   // first step of the current idle period
+    int lastAsked;   // the car is asked at least once every idle step
+};
+
+// "none" (or an unknown name) gives NULL: the car stays where it is
+ElevatorParkingStrategy* CreateParkingStrategy(const std::string& name, int numFloors,
+    const ElevatorParkingParams& params = ElevatorParkingParams());
+const std::vector<std::string>& GetParkingStrategyNames();
+bool IsParkingStrategy(const std::string& name);
+
+#endif
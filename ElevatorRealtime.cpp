@@ -0,0 +1,397 @@
+#include "ElevatorRealtime.h"
+#include "ElevatorStrategyRegistry.h"
+#include "ElevatorParking.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <afunix.h>
+#pragma comment(lib, "Ws2_32.lib")
+typedef SOCKET ECSocket;
+static const ECSocket EC_BAD_SOCKET = INVALID_SOCKET;
+static int PollSockets(WSAPOLLFD* fds, size_t n, int timeoutMs) { return WSAPoll(fds, (ULONG)n, timeoutMs); }
+static void CloseSocket(ECSocket s) { closesocket(s); }
+static void RemovePath(const std::string& path) { DeleteFileA(path.c_str()); }
+static void SetNonBlocking(ECSocket s) { u_long mode = 1; ioctlsocket(s, FIONBIO, &mode); }
+static bool WouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+typedef WSAPOLLFD ECPollFd;
+static const int EC_SEND_FLAGS = 0;
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+typedef int ECSocket;
+static const ECSocket EC_BAD_SOCKET = -1;
+static int PollSockets(pollfd* fds, size_t n, int timeoutMs) { return poll(fds, (nfds_t)n, timeoutMs); }
+static void CloseSocket(ECSocket s) { close(s); }
+static void RemovePath(const std::string& path) { unlink(path.c_str()); }
+static void SetNonBlocking(ECSocket s) { fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK); }
+static bool WouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK; }
+typedef pollfd ECPollFd;
+#if defined(MSG_NOSIGNAL)
+static const int EC_SEND_FLAGS = MSG_NOSIGNAL;   // a client hanging up must not kill the sim
+#else
+static const int EC_SEND_FLAGS = 0;
+#endif
+#endif
+
+static const char* GetDirName(EC_ELEVATOR_DIR dir) {
+    switch (dir) {
+    case EC_ELEVATOR_UP: return "UP";
+    case EC_ELEVATOR_DOWN: return "DOWN";
+    default: return "STOPPED";
+    }
+}
+
+// ElevatorRealtimeServer Implementation
+ElevatorRealtimeServer::ElevatorRealtimeServer(ECElevatorSim& simIn)
+    : sim(simIn), listenFd((intptr_t)EC_BAD_SOCKET), wakeSendFd((intptr_t)EC_BAD_SOCKET), wakeRecvFd((intptr_t)EC_BAD_SOCKET), stopping(false), quitRequested(false), nextStep(0),
+      stamps(ECElevatorSim::SUBMIT_QUEUE_SIZE), lastFloor(simIn.GetCurrFloor()), lastDir(simIn.GetCurrDir()),
+      numReceived(0), numRejected(0), numDisconnected(0), numDecisions(0) {
+    sim.Attach(this);
+}
+
+ElevatorRealtimeServer::~ElevatorRealtimeServer() {
+    Close();
+    sim.Detach(this);
+}
+
+bool ElevatorRealtimeServer::Open(const std::string& pathIn) {
+#if defined(_WIN32)
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        return false;
+    }
+#endif
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (pathIn.size() >= sizeof(addr.sun_path)) {
+        return false;
+    }
+    std::strncpy(addr.sun_path, pathIn.c_str(), sizeof(addr.sun_path) - 1);
+
+    ECSocket fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == EC_BAD_SOCKET) {
+        return false;
+    }
+    RemovePath(pathIn);   // stale socket of an earlier run
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 8) != 0) {
+        CloseSocket(fd);
+        return false;
+    }
+
+    //the wake-up pair is our own first connection
+    ECSocket wakeSend = socket(AF_UNIX, SOCK_STREAM, 0);
+    ECSocket wakeRecv = EC_BAD_SOCKET;
+    if (wakeSend != EC_BAD_SOCKET && connect(wakeSend, (sockaddr*)&addr, sizeof(addr)) == 0) {
+        wakeRecv = accept(fd, NULL, NULL);
+    }
+    if (wakeRecv == EC_BAD_SOCKET) {
+        if (wakeSend != EC_BAD_SOCKET) CloseSocket(wakeSend);
+        CloseSocket(fd);
+        RemovePath(pathIn);
+        return false;
+    }
+    SetNonBlocking(wakeSend);
+    SetNonBlocking(wakeRecv);
+
+    path = pathIn;
+    listenFd = (intptr_t)fd;
+    wakeSendFd = (intptr_t)wakeSend;
+    wakeRecvFd = (intptr_t)wakeRecv;
+    stopping = false;
+    reader = std::thread(&ElevatorRealtimeServer::readerLoop, this);
+    return true;
+}
+
+void ElevatorRealtimeServer::Close() {
+    if (listenFd == (intptr_t)EC_BAD_SOCKET) return;
+
+    stopping = true;
+    if (reader.joinable()) {
+        reader.join();
+    }
+    for (auto& client : clients) {
+        CloseSocket((ECSocket)client.fd);
+    }
+    clients.clear();
+    CloseSocket((ECSocket)wakeSendFd);
+    CloseSocket((ECSocket)wakeRecvFd);
+    CloseSocket((ECSocket)listenFd);
+    listenFd = wakeSendFd = wakeRecvFd = (intptr_t)EC_BAD_SOCKET;
+    RemovePath(path);
+#if defined(_WIN32)
+    WSACleanup();
+#endif
+}
+
+// readerLoop: accepts clients, turns their lines into Submit calls and writes the
+// replies and step lines; wakes up on the sim thread's signal, and regularly to notice Close()
+void ElevatorRealtimeServer::readerLoop() {
+    std::vector<ECPollFd> fds;
+    char buf[4096];
+
+    while (!stopping.load(std::memory_order_acquire)) {
+        fds.resize(clients.size() + 2);
+        fds[0].fd = (ECSocket)listenFd;
+        fds[1].fd = (ECSocket)wakeRecvFd;
+        for (size_t i = 0; i < clients.size(); ++i) {
+            fds[i + 2].fd = (ECSocket)clients[i].fd;
+        }
+        for (size_t i = 0; i < fds.size(); ++i) {
+            bool writing = i >= 2 && !clients[i - 2].outgoing.empty();
+            fds[i].events = writing ? (POLLIN | POLLOUT) : POLLIN;
+            fds[i].revents = 0;
+        }
+        if (PollSockets(fds.data(), fds.size(), 50) < 0) {
+            continue;
+        }
+
+        if (fds[1].revents != 0) {
+            while (recv((ECSocket)wakeRecvFd, buf, sizeof(buf), 0) > 0) {}
+        }
+        takeOutbox();
+
+        std::vector<bool> closed(clients.size(), false);
+        for (size_t i = 0; i < clients.size(); ++i) {
+            Client& client = clients[i];
+            if (fds[i + 2].revents & (POLLIN | POLLHUP | POLLERR)) {
+                int n = (int)recv((ECSocket)client.fd, buf, sizeof(buf), 0);
+                if (n == 0 || (n < 0 && !WouldBlock())) {
+                    closed[i] = true;
+                    continue;
+                }
+                if (n > 0) {
+                    client.pending.append(buf, n);
+                    size_t start = 0, end;
+                    while ((end = client.pending.find('\n', start)) != std::string::npos) {
+                        handleLine(client, client.pending.substr(start, end - start));
+                        start = end + 1;
+                    }
+                    client.pending.erase(0, start);
+                }
+            }
+            closed[i] = !flush(client);
+        }
+
+        for (size_t k = clients.size(); k-- > 0;) {
+            if (!closed[k]) continue;
+            CloseSocket((ECSocket)clients[k].fd);
+            clients.erase(clients.begin() + k);
+        }
+        if (fds[0].revents & POLLIN) {
+            ECSocket fd = accept((ECSocket)listenFd, NULL, NULL);
+            if (fd != EC_BAD_SOCKET) {
+                SetNonBlocking(fd);
+                clients.push_back(Client{ (intptr_t)fd, std::string(), std::string() });
+            }
+        }
+    }
+}
+
+void ElevatorRealtimeServer::handleLine(Client& client, const std::string& line) {
+    auto received = std::chrono::steady_clock::now();
+    if (line.compare(0, 4, "quit") == 0) {
+        quitRequested.store(true, std::memory_order_release);
+        return;
+    }
+
+    int src, dest;
+    std::stringstream ss(line);
+    if (!(ss >> src >> dest)) {
+        return;   // blank or malformed
+    }
+    numReceived++;
+
+    bool maintenance = (src == -1 && dest == -1) || (src == 0 && dest == 0);
+    int numFloors = sim.GetNumFloors();
+    if (!maintenance && (src < 1 || src > numFloors || dest < 1 || dest > numFloors || src == dest)) {
+        numRejected++;
+        client.outgoing += "error bad floors\n";
+        return;
+    }
+
+    int time = nextStep.load(std::memory_order_acquire);
+    ElevatorRequestHandle handle;
+    if (!sim.Submit(ECElevatorSimRequest(time, src, dest), &handle)) {
+        numRejected++;
+        client.outgoing += "error busy\n";
+        return;
+    }
+    if (!maintenance) {
+        Stamp stamp;
+        stamp.handle = handle;
+        stamp.received = received;
+        stamps.TryPush(stamp);   // same capacity as the submit queue; if full the request just isn't timed
+    }
+
+    char reply[64];
+    snprintf(reply, sizeof(reply), "ok %u %d\n", handle, time);
+    client.outgoing += reply;
+}
+
+// takeOutbox: the step lines of the sim thread go to the end of every client's queue
+void ElevatorRealtimeServer::takeOutbox() {
+    std::string lines;
+    {
+        std::lock_guard<std::mutex> lock(outboxMutex);
+        lines.swap(outbox);
+    }
+    if (lines.empty()) return;
+    for (auto& client : clients) {
+        client.outgoing += lines;
+    }
+}
+
+// flush: writes what the socket takes without waiting; false if the client is gone
+// or has let its backlog grow past MAX_CLIENT_BACKLOG
+bool ElevatorRealtimeServer::flush(Client& client) {
+    size_t sent = 0;
+    while (sent < client.outgoing.size()) {
+        int n = (int)send((ECSocket)client.fd, client.outgoing.data() + sent, (int)(client.outgoing.size() - sent), EC_SEND_FLAGS);
+        if (n > 0) {
+            sent += n;
+        }
+        else if (n < 0 && WouldBlock()) {
+            break;
+        }
+        else {
+            return false;
+        }
+    }
+    client.outgoing.erase(0, sent);
+    if (client.outgoing.size() > MAX_CLIENT_BACKLOG) {
+        numDisconnected++;
+        return false;
+    }
+    return true;
+}
+
+// wakeReader: the wake-up socket is non-blocking; if it is full a wake-up is pending anyway
+void ElevatorRealtimeServer::wakeReader() {
+    char byte = 1;
+    send((ECSocket)wakeSendFd, &byte, 1, EC_SEND_FLAGS);
+}
+
+void ElevatorRealtimeServer::Update() {
+    arrived.push_back(sim.GetCurrEvent().request);
+}
+
+// AfterStep: a request is decided by the step that takes it in (its arrival event).
+// The reader pushes the stamp right after Submit, so the simulator can take a request
+// in before its stamp is on the ring; such arrivals are matched once more next step
+void ElevatorRealtimeServer::AfterStep(int time) {
+    Stamp stamp;
+    while (stamps.TryPop(stamp)) {
+        undecided[stamp.handle] = stamp.received;
+    }
+
+    std::vector<Stamp> decided;
+    auto decide = [&](ElevatorRequestHandle handle) {
+        auto it = undecided.find(handle);
+        if (it == undecided.end()) return false;
+        Stamp d;
+        d.handle = handle;
+        d.received = it->second;
+        decided.push_back(d);
+        undecided.erase(it);
+        return true;
+    };
+    for (ElevatorRequestHandle handle : arrivedEarly) {
+        decide(handle);
+    }
+    arrivedEarly.clear();
+    for (ElevatorRequestHandle handle : arrived) {
+        if (!decide(handle)) arrivedEarly.push_back(handle);
+    }
+    arrived.clear();
+
+    int floor = sim.GetCurrFloor();
+    EC_ELEVATOR_DIR dir = sim.GetCurrDir();
+    if (decided.empty() && floor == lastFloor && dir == lastDir) {
+        return;
+    }
+    lastFloor = floor;
+    lastDir = dir;
+
+    std::string line = "step " + std::to_string(time) + " " + std::to_string(floor) + " " + GetDirName(dir);
+    for (const auto& d : decided) {
+        line += " " + std::to_string(d.handle);
+    }
+    line += "\n";
+    {
+        std::lock_guard<std::mutex> lock(outboxMutex);
+        outbox += line;
+    }
+    wakeReader();
+    numDecisions++;
+
+    auto queued = std::chrono::steady_clock::now();
+    for (const auto& d : decided) {
+        latenciesUs.push_back(std::chrono::duration<double, std::micro>(queued - d.received).count());
+    }
+}
+
+void ElevatorRealtimeServer::PrintReport(std::ostream& out) const {
+    out << "Live requests: " << numReceived.load() << " received, " << numRejected.load() << " rejected\n"
+        << "Decisions sent: " << numDecisions << "\n";
+    if (numDisconnected > 0) {
+        out << "Clients disconnected for not reading: " << numDisconnected << "\n";
+    }
+    if (latenciesUs.empty()) {
+        return;
+    }
+
+    std::vector<double> sorted = latenciesUs;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&sorted](double fraction) {
+        size_t rank = (size_t)std::ceil(fraction * sorted.size());
+        return sorted[std::max<size_t>(rank, 1) - 1];
+    };
+    out << std::fixed << std::setprecision(2)
+        << "Input-to-decision latency (ms): p50 " << percentile(0.5) / 1000.0
+        << ", p99 " << percentile(0.99) / 1000.0
+        << ", max " << sorted.back() / 1000.0
+        << " (" << sorted.size() << " requests)\n";
+}
+
+bool RunRealtime(const ElevatorTrace& trace, const ElevatorRunOptions& options,
+    const ElevatorRealtimeOptions& realtime, ElevatorRunReport& report) {
+    ECElevatorSim simulator(trace.numFloors, trace.requests, ElevatorStrategyRegistry::Instance().Create(options.strategy));
+    simulator.SetEventLog(options.eventLog);
+    simulator.SetParkingStrategy(CreateParkingStrategy(options.parking, trace.numFloors, options.parkingParams));
+
+    ElevatorRealtimeServer server(simulator);
+    if (!server.Open(realtime.socketPath)) {
+        std::cout << "Couldn't listen on: " << realtime.socketPath << std::endl;
+        return false;
+    }
+    std::cout << "Listening on " << realtime.socketPath << ", one step every " << realtime.tickMs << " ms" << std::endl;
+
+    // fixed-rate ticks: a slow step is caught up on instead of shifting the clock
+    auto tick = std::chrono::milliseconds(std::max(1, realtime.tickMs));
+    auto nextTick = std::chrono::steady_clock::now();
+    for (int t = 0; t < trace.lenSim && !server.IsQuitRequested(); ++t) {
+        server.SetNextStep(t);
+        std::this_thread::sleep_until(nextTick);
+        nextTick += tick;
+
+        simulator.Simulate(t);
+        server.AfterStep(t);
+    }
+    server.Close();
+
+    report = BuildRunReport(simulator, options.energy);
+    report.strategy = options.strategy;
+    server.PrintReport(std::cout);
+    return true;
+}
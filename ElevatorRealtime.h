@@ -0,0 +1,126 @@
+#pragma once
+#ifndef ElevatorRealtime_h
+#define ElevatorRealtime_h
+
+#include "ECElevatorSim.h"
+#include "ECMpscRing.h"
+#include "ElevatorReport.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+//*****************************************************************************
+// Real-time mode: hall calls come in over a local (Unix domain) socket while
+// the simulation runs one step per tick of wall-clock time.
+//
+// Protocol, one line per message (any number of clients):
+//   client -> sim:  "<src> <dest>"    passenger request, stamped with the next sim step
+//                   "-1 -1" / "0 0"   maintenance start / end
+//                   "quit"            stop the run
+//   sim -> clients: "ok <handle> <time>"                   request queued
+//                   "error <reason>"                       request rejected
+//                   "step <time> <floor> <dir> [<handle>...]"
+//                        after a step that changed the car or took in requests; the
+//                        handles are the requests this decision is the first to include
+//
+// Input-to-decision latency = from reading a request off the socket to handing
+// the first step line that includes it to the reader thread
+//
+// Only the reader thread talks to the clients, and never blocks on one: the sim
+// thread leaves its step lines in an outbox and wakes the reader, which queues
+// them per client and writes what each socket takes. A client that stops reading
+// is disconnected once its backlog passes MAX_CLIENT_BACKLOG
+
+struct ElevatorRealtimeOptions
+{
+    std::string socketPath;
+    int tickMs = 100;       // wall-clock length of one simulation step
+};
+
+class ElevatorRealtimeServer : public ECObserver
+{
+public:
+    explicit ElevatorRealtimeServer(ECElevatorSim& sim);
+    ~ElevatorRealtimeServer();
+
+    // Listen on path (a Unix domain socket; on Windows 10+ through afunix.h) and start
+    // reading requests; false if the socket can't be created
+    bool Open(const std::string& path);
+    void Close();
+
+    // Sim thread: the step about to be simulated (new requests are stamped with it)
+    void SetNextStep(int time) { nextStep.store(time, std::memory_order_release); }
+
+    // Sim thread: after Simulate(time), send the decision and account latencies
+    void AfterStep(int time);
+
+    bool IsQuitRequested() const { return quitRequested.load(std::memory_order_acquire); }
+
+    void PrintReport(std::ostream& out) const;
+
+    // Sim thread, during Simulate: a request was taken in
+    void Update() override;
+    ECEventMask GetEventMask() const override { return ECEventBit(EC_SIM_EV_REQUEST_ARRIVED); }
+
+    static const size_t MAX_CLIENT_BACKLOG = 64 * 1024;   // bytes not yet taken by a client
+
+private:
+    struct Client
+    {
+        intptr_t fd;
+        std::string pending;    // partial line
+        std::string outgoing;   // replies and step lines the socket hasn't taken yet
+    };
+
+    // receive time of a request, handed from the reader thread to the sim thread
+    struct Stamp
+    {
+        ElevatorRequestHandle handle = 0;
+        std::chrono::steady_clock::time_point received;
+    };
+
+    void readerLoop();
+    void handleLine(Client& client, const std::string& line);
+    void takeOutbox();
+    bool flush(Client& client);
+    void wakeReader();
+
+    ECElevatorSim& sim;
+    intptr_t listenFd;
+    intptr_t wakeSendFd;                // sim thread: a byte here wakes the reader
+    intptr_t wakeRecvFd;
+    std::string path;
+    std::thread reader;
+    std::atomic<bool> stopping;
+    std::atomic<bool> quitRequested;
+    std::atomic<int> nextStep;
+
+    std::vector<Client> clients;        // reader thread only (plus close)
+    std::mutex outboxMutex;             // held only to append to or take the outbox
+    std::string outbox;                 // step lines for every client, not handed out yet
+    ECMpscRing<Stamp> stamps;
+    std::unordered_map<ElevatorRequestHandle, std::chrono::steady_clock::time_point> undecided;
+                                        // sim thread: stamps taken off the ring, not in a decision yet
+    std::vector<ElevatorRequestHandle> arrived;       // sim thread: taken in during this step
+    std::vector<ElevatorRequestHandle> arrivedEarly;  // taken in last step before their stamp came off the ring
+
+    int lastFloor;
+    EC_ELEVATOR_DIR lastDir;
+    std::atomic<long long> numReceived;
+    std::atomic<long long> numRejected;
+    long long numDisconnected;          // reader thread: clients dropped for not reading
+    long long numDecisions;
+    std::vector<double> latenciesUs;    // sim thread
+};
+
+// Run the trace's requests plus live input for trace.lenSim steps (or until "quit")
+bool RunRealtime(const ElevatorTrace& trace, const ElevatorRunOptions& options,
+    const ElevatorRealtimeOptions& realtime, ElevatorRunReport& report);
+
+#endif
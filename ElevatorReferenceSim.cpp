@@ -0,0 +1,226 @@
+#include "ElevatorReferenceSim.h"
+#include <algorithm>
+
+// ElevatorReferenceSim Implementation
+ElevatorReferenceSim::ElevatorReferenceSim(int numFloorsIn, const std::vector<ECElevatorSimRequest>& listRequests)
+    : numFloors(numFloorsIn), currFloor(1), currDir(EC_ELEVATOR_STOPPED), inMaintenance(false),
+      requests(listRequests), numMaintenanceDone(0) {
+    for (size_t i = 0; i < requests.size(); ++i) {
+        if (!isPassenger(requests[i])) {
+            maintenanceOrder.push_back(i);
+        }
+    }
+    std::stable_sort(maintenanceOrder.begin(), maintenanceOrder.end(), [this](size_t a, size_t b) {
+        return requests[a].GetTime() < requests[b].GetTime();
+    });
+}
+
+void ElevatorReferenceSim::Simulate(int lenSim) {
+    handleMaintenance(lenSim);
+    if (inMaintenance) {
+        return;
+    }
+
+    if (!handlePassengers(lenSim)) {
+        updateElevator(lenSim);
+    }
+}
+
+EC_REQUEST_STATE ElevatorReferenceSim::GetState(size_t index, int time) const {
+    const ECElevatorSimRequest& req = requests[index];
+    if (req.GetTime() > time) return EC_REQUEST_PENDING;
+    if (!isPassenger(req)) return EC_REQUEST_SERVICED;
+    if (req.IsServiced()) return EC_REQUEST_SERVICED;
+    return req.IsFloorRequestDone() ? EC_REQUEST_RIDING : EC_REQUEST_WAITING;
+}
+
+void ElevatorReferenceSim::CountPassengers(int time, int& numWaiting, int& numRiding, int& numServiced) const {
+    numWaiting = numRiding = numServiced = 0;
+    for (size_t i = 0; i < requests.size(); ++i) {
+        if (!isPassenger(requests[i])) continue;
+        switch (GetState(i, time)) {
+        case EC_REQUEST_WAITING: numWaiting++; break;
+        case EC_REQUEST_RIDING: numRiding++; break;
+        case EC_REQUEST_SERVICED: numServiced++; break;
+        default: break;
+        }
+    }
+}
+
+// handleMaintenance helper method, carries out the maintenance requests made by now
+void ElevatorReferenceSim::handleMaintenance(int time) {
+    while (numMaintenanceDone < maintenanceOrder.size() &&
+        requests[maintenanceOrder[numMaintenanceDone]].GetTime() <= time) {
+        ECElevatorSimRequest& req = requests[maintenanceOrder[numMaintenanceDone++]];
+        req.SetArriveTime(time);
+        if (req.IsMaintenanceStart()) {
+            inMaintenance = true;
+            currDir = EC_ELEVATOR_STOPPED;
+        }
+        else {
+            inMaintenance = false;
+        }
+    }
+}
+
+// handlePassengers helper method, handles the passengers
+bool ElevatorReferenceSim::handlePassengers(int time) {
+    // Check if there's a passenger already loaded and a new request at the same floor
+    for (const auto& req : requests) {
+        if (!isPassenger(req)) continue;
+        if (!req.IsFloorRequestDone() && req.GetFloorSrc() == currFloor && req.GetTime() == time) {
+            // Check if we already picked up someone at this floor
+            for (const auto& otherReq : requests) {
+                if (!isPassenger(otherReq)) continue;
+                if (otherReq.IsFloorRequestDone() && !otherReq.IsServiced() &&
+                    otherReq.GetFloorSrc() == currFloor && otherReq.GetTime() < time) {
+                    return false;  // Don't allow new pickup, elevator should be moving
+                }
+            }
+        }
+    }
+
+    // Normal passenger handling
+    if (countPassengersAtFloor(time) == 0) return false;
+
+    handleAllPassengersAtFloor(time);
+    determineDirection(time);
+    return true;
+}
+
+// countPassengersAtFloor helper method, counts the number of passengers at the current floor
+int ElevatorReferenceSim::countPassengersAtFloor(int time) {
+    int count = 0;
+    for (const auto& req : requests) {
+        if (!isPassenger(req) || req.GetTime() > time) continue;
+
+        if ((req.IsFloorRequestDone() && !req.IsServiced() && currFloor == req.GetFloorDest()) ||
+            (!req.IsFloorRequestDone() && currFloor == req.GetFloorSrc())) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// handleAllPassengersAtFloor helper method, unloads and loads everyone at the current floor
+void ElevatorReferenceSim::handleAllPassengersAtFloor(int time) {
+    for (auto& req : requests) {
+        if (!isPassenger(req) || req.GetTime() > time) continue;
+
+        if (req.IsFloorRequestDone() && !req.IsServiced() && currFloor == req.GetFloorDest()) {
+            req.SetArriveTime(time);
+            req.SetServiced(true);
+        }
+
+        if (!req.IsFloorRequestDone() && currFloor == req.GetFloorSrc()) {
+            req.SetFloorRequestDone(true);
+        }
+    }
+}
+
+// determineDirection helper method: keep going while there are requests ahead,
+// otherwise head for the earliest request still waiting for service
+void ElevatorReferenceSim::determineDirection(int currTime) {
+    if (currDir == EC_ELEVATOR_UP && hasRequestsAbove(currTime)) return;
+    if (currDir == EC_ELEVATOR_DOWN && hasRequestsBelow(currTime)) return;
+
+    int targetFloor = getEarliestRequestFloor(currTime);
+    if (targetFloor == -1 || targetFloor == currFloor) {
+        currDir = EC_ELEVATOR_STOPPED;
+    }
+    else {
+        currDir = (targetFloor > currFloor) ? EC_ELEVATOR_UP : EC_ELEVATOR_DOWN;
+    }
+}
+
+bool ElevatorReferenceSim::hasRequestsAbove(int currTime) const {
+    for (const auto& req : requests) {
+        if (!isPassenger(req) || req.IsServiced() || req.GetTime() > currTime) continue;
+        if (req.GetRequestedFloor() > currFloor) return true;
+    }
+    return false;
+}
+
+bool ElevatorReferenceSim::hasRequestsBelow(int currTime) const {
+    for (const auto& req : requests) {
+        if (!isPassenger(req) || req.IsServiced() || req.GetTime() > currTime) continue;
+        if (req.GetRequestedFloor() < currFloor) return true;
+    }
+    return false;
+}
+
+// getEarliestRequestFloor helper method, first request in list order among the earliest made
+int ElevatorReferenceSim::getEarliestRequestFloor(int currTime) const {
+    int earliestTime = INT_MAX;
+    int targetFloor = -1;
+    for (const auto& req : requests) {
+        if (!isPassenger(req)) continue;
+        if (!req.IsServiced() && req.GetTime() <= currTime && req.GetTime() < earliestTime) {
+            earliestTime = req.GetTime();
+            targetFloor = req.GetRequestedFloor();
+        }
+    }
+    return targetFloor;
+}
+
+void ElevatorReferenceSim::updateElevator(int time) {
+    handleStop(time);
+    moveElevator();
+    determineDirection(time);
+}
+
+void ElevatorReferenceSim::moveElevator() {
+    if (currDir == EC_ELEVATOR_UP && currFloor < numFloors) {
+        currFloor++;
+    }
+    else if (currDir == EC_ELEVATOR_DOWN && currFloor > 1) {
+        currFloor--;
+    }
+}
+
+void ElevatorReferenceSim::handleStop(int currTime) {
+    bool handledPassenger = false;
+    handleUnloading(currTime, handledPassenger);
+    handleLoading(currTime, handledPassenger);
+    determineDirection(currTime);
+}
+
+// hasExistingPickup helper method, someone made earlier already boarded at this floor
+bool ElevatorReferenceSim::hasExistingPickup(int floor, int currTime) {
+    for (const auto& req : requests) {
+        if (!isPassenger(req)) continue;
+        if (req.IsFloorRequestDone() && !req.IsServiced() &&
+            req.GetFloorSrc() == floor && req.GetTime() < currTime) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// handleUnloading helper method, every rider for this floor gets off
+void ElevatorReferenceSim::handleUnloading(int currTime, bool& handledPassenger) {
+    for (auto& req : requests) {
+        if (!isPassenger(req)) continue;
+        if (req.IsFloorRequestDone() && !req.IsServiced() && req.GetFloorDest() == currFloor) {
+            req.SetServiced(true);
+            req.SetArriveTime(currTime);
+            handledPassenger = true;
+        }
+    }
+}
+
+// handleLoading helper method, one passenger boards, and only if nobody got off
+void ElevatorReferenceSim::handleLoading(int currTime, bool handledPassenger) {
+    if (handledPassenger) return;
+
+    for (auto& req : requests) {
+        if (!isPassenger(req)) continue;
+        if (!req.IsFloorRequestDone() && !req.IsServiced() &&
+            req.GetFloorSrc() == currFloor && req.GetTime() <= currTime) {
+            if (!hasExistingPickup(currFloor, currTime)) {
+                req.SetFloorRequestDone(true);
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+#ifndef ElevatorReferenceSim_h
+#define ElevatorReferenceSim_h
+
+#include "ECElevatorSim.h"
+#include <vector>
+
+//*****************************************************************************
+// Reference engine: the original simulation rules written the plain way, with
+// every question answered by scanning the whole request list and the default
+// dispatch policy built in. It is slow on purpose and only serves as the oracle
+// for the fuzzer; any change to ECElevatorSim must keep matching it.
+//
+// Maintenance requests are carried out at the start of a step in (time, list)
+// order and freeze the car until the end request, as in ECElevatorSim.
+// The list order must be the handle order of the engine it is compared with
+
+class ElevatorReferenceSim
+{
+public:
+    ElevatorReferenceSim(int numFloors, const std::vector<ECElevatorSimRequest>& listRequests);
+
+    void Simulate(int lenSim);
+
+    int GetNumFloors() const { return numFloors; }
+    int GetCurrFloor() const { return currFloor; }
+    EC_ELEVATOR_DIR GetCurrDir() const { return currDir; }
+    bool IsInMaintenance() const { return inMaintenance; }
+
+    // All requests in list order, with their progress
+    const std::vector<ECElevatorSimRequest>& GetRequests() const { return requests; }
+
+    // Same meaning as ElevatorRequestResult::state / ElevatorLiveStats (requests made by time)
+    EC_REQUEST_STATE GetState(size_t index, int time) const;
+    void CountPassengers(int time, int& numWaiting, int& numRiding, int& numServiced) const;
+
+private:
+    bool isPassenger(const ECElevatorSimRequest& req) const { return !req.IsMaintenanceStart() && !req.IsMaintenanceEnd(); }
+    void handleMaintenance(int time);
+
+    bool handlePassengers(int time);
+    int countPassengersAtFloor(int time);
+    void handleAllPassengersAtFloor(int time);
+    void updateElevator(int time);
+    void handleStop(int currTime);
+    void moveElevator();
+    void determineDirection(int currTime);
+    bool hasRequestsAbove(int currTime) const;
+    bool hasRequestsBelow(int currTime) const;
+    int getEarliestRequestFloor(int currTime) const;
+    bool hasExistingPickup(int floor, int currTime);
+    void handleUnloading(int currTime, bool& handledPassenger);
+    void handleLoading(int currTime, bool handledPassenger);
+
+    int numFloors;
+    int currFloor;
+    EC_ELEVATOR_DIR currDir;
+    bool inMaintenance;
+    std::vector<ECElevatorSimRequest> requests;
+    std::vector<size_t> maintenanceOrder;   // maintenance requests by (time, index)
+    size_t numMaintenanceDone;
+};
+
+#endif
@@ -0,0 +1,144 @@
+#include "ElevatorRender.h"
+#include "ECGraphicViewImp.h"
+#include "ECVideoWriter.h"
+#include "ElevatorObserver.h"
+#include "ElevatorParking.h"
+#include "ElevatorStrategyRegistry.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+
+// One simulator + offscreen view + viewer, as the window would have them
+struct ElevatorRenderSession
+{
+    ECElevatorSim simulator;
+    ECGraphicViewImp view;
+    ElevatorObserver observer;
+
+    ElevatorRenderSession(const ElevatorTrace& trace, const ElevatorRunOptions& options, const ElevatorRenderOptions& render)
+        : simulator(trace.numFloors, trace.requests, ElevatorStrategyRegistry::Instance().Create(options.strategy)),
+          view(render.width, render.height, true),
+          observer(view, simulator, trace.lenSim) {
+        simulator.SetParkingStrategy(CreateParkingStrategy(options.parking, trace.numFloors, options.parkingParams));
+        observer.SetSpeed(render.speed);
+        view.Attach(&observer);
+    }
+};
+
+static bool IsY4M(const std::string& path) {
+    return path.size() >= 4 && path.compare(path.size() - 4, 4, ".y4m") == 0;
+}
+
+// FramePath helper function, file name of one image of a sequence
+static std::string FramePath(const std::string& pattern, int frame) {
+    std::string format = pattern;
+    if (format.find('%') == std::string::npos) {
+        size_t dot = format.rfind('.');
+        format.insert(dot == std::string::npos ? format.size() : dot, "_%06d");
+    }
+    char path[1024];
+    snprintf(path, sizeof(path), format.c_str(), frame);
+    return path;
+}
+
+bool RenderRun(const ElevatorTrace& trace, const ElevatorRunOptions& options, const ElevatorRenderOptions& render, std::ostream& out) {
+    if (render.speed != 1 && render.speed != 10 && render.speed != 100) {
+        out << "Render speed must be 1, 10 or 100" << std::endl;
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    //a pass without drawing tells how many frames there are
+    int numFrames = 0;
+    {
+        ElevatorRenderSession session(trace, options, render);
+        session.view.SetDrawingEnabled(false);
+        while (session.view.RenderFrame()) {
+            numFrames++;
+        }
+    }
+    if (numFrames == 0) {
+        out << "Nothing to render" << std::endl;
+        return false;
+    }
+
+    int numWorkers = render.numWorkers > 0 ? render.numWorkers : std::max(1, (int)std::thread::hardware_concurrency());
+    numWorkers = std::min(numWorkers, numFrames);
+    bool y4m = IsY4M(render.output);
+
+    std::atomic<bool> failed(false);
+    std::mutex errorLock;
+    std::string error;
+    auto fail = [&](const std::string& message) {
+        std::lock_guard<std::mutex> guard(errorLock);
+        if (error.empty()) error = message;
+        failed = true;
+    };
+    auto partPath = [&](int w) {
+        return w == 0 ? render.output : render.output + ".part" + std::to_string(w);
+    };
+
+    auto worker = [&](int w) {
+        int begin = (int)((long long)numFrames * w / numWorkers);
+        int end = (int)((long long)numFrames * (w + 1) / numWorkers);
+        ElevatorRenderSession session(trace, options, render);
+
+        //catch up with the first frame of the range
+        session.view.SetDrawingEnabled(false);
+        for (int f = 0; f < begin; ++f) {
+            session.view.RenderFrame();
+        }
+        session.view.SetDrawingEnabled(true);
+
+        ECY4MWriter writer;
+        if (y4m && !writer.Open(partPath(w), render.width, render.height, session.view.GetFrameRate(), w == 0)) {
+            fail("Couldn't create " + partPath(w));
+            return;
+        }
+        std::vector<unsigned char> rgba;
+        for (int f = begin; f < end && !failed; ++f) {
+            session.view.RenderFrame();
+            if (y4m) {
+                if (!session.view.ReadFrame(rgba) || !writer.WriteFrame(rgba)) {
+                    fail("Couldn't write frame " + std::to_string(f) + " to " + partPath(w));
+                }
+            }
+            else if (!session.view.SaveFrame(FramePath(render.output, f))) {
+                fail("Couldn't save " + FramePath(render.output, f));
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int w = 1; w < numWorkers; ++w) {
+        threads.emplace_back(worker, w);
+    }
+    worker(0);
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    //the pieces of the stream in order
+    if (y4m) {
+        for (int w = 1; w < numWorkers; ++w) {
+            if (!failed && !ECY4MWriter::AppendPart(render.output, partPath(w))) {
+                fail("Couldn't append " + partPath(w));
+            }
+            remove(partPath(w).c_str());
+        }
+    }
+    if (failed) {
+        out << error << std::endl;
+        return false;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    out << "Rendered " << numFrames << " frames (" << std::fixed << std::setprecision(1)
+        << numFrames / 60.0 << " s of video) with " << numWorkers << " worker(s) in "
+        << std::setprecision(2) << seconds << " s, " << std::setprecision(1) << numFrames / seconds << " frames/s" << std::endl;
+    return true;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#ifndef ElevatorRender_h
+#define ElevatorRender_h
+
+#include "ElevatorReport.h"
+#include "ElevatorTraceReader.h"
+#include <iostream>
+#include <string>
+
+//*****************************************************************************
+// Offscreen rendering of a run, frame by frame as the viewer would show it at
+// 60 frames per second, but as fast as the frames can be drawn and without a
+// window (works on a machine without a display server).
+//
+// The frames are split into equal ranges, one per worker thread. Each worker
+// runs its own simulator and fast-forwards (without drawing) to the start of
+// its range, so the frames come out the same for any number of workers
+
+struct ElevatorRenderOptions
+{
+    // "<name>.y4m": one raw video stream (convert with e.g. ffmpeg -i run.y4m run.mp4);
+    // anything else: one image per frame, a printf pattern such as "frames/f%05d.png"
+    // ("_%06d" is added before the extension if there is no %)
+    std::string output;
+    int speed = 10;        // simulation steps per 85 frames, as in the viewer: 1, 10 or 100
+    int numWorkers = 0;    // 0: one per core
+    int width = 500;
+    int height = 800;
+};
+
+// Renders the whole run; false (and a message to out) on failure
+bool RenderRun(const ElevatorTrace& trace, const ElevatorRunOptions& options, const ElevatorRenderOptions& render, std::ostream& out);
+
+#endif
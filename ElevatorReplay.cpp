@@ -0,0 +1,119 @@
+#include "ElevatorReplay.h"
+#include <algorithm>
+
+// remove a passenger from a list by request index
+static bool takePassenger(std::vector<ElevatorReplayPassenger>& list, uint32_t request, ElevatorReplayPassenger& out) {
+    for (size_t i = 0; i < list.size(); ++i) {
+        if (list[i].request == request) {
+            out = list[i];
+            list.erase(list.begin() + i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// ElevatorReplayState Implementation
+void ElevatorReplayState::Apply(const ElevatorEventRecord& rec) {
+    ElevatorReplayPassenger p;
+    switch (rec.type) {
+    case EC_SIM_EV_REQUEST_ARRIVED:
+        waiting.push_back(ElevatorReplayPassenger{ rec.request, rec.floor, rec.aux });
+        break;
+    case EC_SIM_EV_BOARDED:
+        if (takePassenger(waiting, rec.request, p)) {
+            riding.push_back(p);
+        }
+        break;
+    case EC_SIM_EV_ALIGHTED:
+        takePassenger(riding, rec.request, p);
+        break;
+    case EC_SIM_EV_WITHDRAWN:
+        takePassenger(waiting, rec.request, p);
+        break;
+    case EC_SIM_EV_CAR_MOVED:
+        floor = rec.floor;
+        break;
+    case EC_SIM_EV_DIRECTION_CHANGED:
+        dir = rec.aux;
+        break;
+    case EC_SIM_EV_MAINTENANCE_START:
+        inMaintenance = true;
+        break;
+    case EC_SIM_EV_MAINTENANCE_END:
+        inMaintenance = false;
+        break;
+    }
+}
+
+// ElevatorReplay Implementation
+ElevatorReplay::ElevatorReplay() : keyframeInterval(100), endTime(0), currTime(-1), hasPending(false) {
+}
+
+bool ElevatorReplay::Open(const std::string& path, int interval) {
+    if (!reader.Open(path)) {
+        return false;
+    }
+    keyframeInterval = std::max(1, interval);
+    keyframes.clear();
+
+    // one pass over the log to build the keyframe index
+    ElevatorReplayState scan;
+    ElevatorEventRecord rec;
+    uint64_t index = 0;
+    int nextKeyframe = 0;
+    endTime = reader.GetHeader().lenSim;
+    while (reader.Next(rec)) {
+        while (rec.time >= nextKeyframe) {
+            keyframes.push_back(Keyframe{ nextKeyframe, index, scan });
+            nextKeyframe += keyframeInterval;
+        }
+        scan.Apply(rec);
+        endTime = std::max(endTime, (int)rec.time);
+        index++;
+    }
+    if (keyframes.empty()) {
+        keyframes.push_back(Keyframe{ 0, 0, scan });
+    }
+
+    restoreKeyframe(0);
+    return true;
+}
+
+void ElevatorReplay::SeekTo(int time) {
+    time = std::max(0, std::min(time, endTime));
+    if (time < currTime) {
+        restoreKeyframe(time);
+    }
+    playForward(time);
+}
+
+// restoreKeyframe helper method, jumps to the last keyframe at or before time
+void ElevatorReplay::restoreKeyframe(int time) {
+    size_t k = std::min(keyframes.size() - 1, (size_t)(time / keyframeInterval));
+    while (k > 0 && keyframes[k].time > time) {
+        k--;
+    }
+    state = keyframes[k].state;
+    reader.Seek(keyframes[k].record);
+    currTime = keyframes[k].time - 1;
+    hasPending = false;
+}
+
+// playForward helper method, applies events up to and including time
+void ElevatorReplay::playForward(int time) {
+    while (true) {
+        if (!hasPending) {
+            if (!reader.Next(pending)) {
+                break;
+            }
+            hasPending = true;
+        }
+        if (pending.time > time) {
+            break;
+        }
+        state.Apply(pending);
+        hasPending = false;
+    }
+    currTime = time;
+}
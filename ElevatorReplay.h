@@ -0,0 +1,73 @@
+#pragma once
+#ifndef ElevatorReplay_h
+#define ElevatorReplay_h
+
+#include "ElevatorEventLog.h"
+#include <string>
+#include <vector>
+
+//*****************************************************************************
+// State of the building reconstructed from an event log
+
+struct ElevatorReplayPassenger
+{
+    uint32_t request;
+    int floorSrc;
+    int floorDest;
+};
+
+struct ElevatorReplayState
+{
+    int floor = 1;
+    int dir = 0;                  // EC_ELEVATOR_DIR
+    bool inMaintenance = false;
+    std::vector<ElevatorReplayPassenger> waiting;   // at their source floor
+    std::vector<ElevatorReplayPassenger> riding;    // in the cabin
+
+    void Apply(const ElevatorEventRecord& rec);
+};
+
+//*****************************************************************************
+// Random access over a recorded event log. Opening makes one pass over the
+// log and keeps a keyframe (state + file position) every keyframeInterval
+// time units; seeking restores the nearest keyframe and replays from there
+
+class ElevatorReplay
+{
+public:
+    ElevatorReplay();
+
+    bool Open(const std::string& path, int keyframeInterval = 100);
+    const ElevatorEventLogHeader& GetHeader() const { return reader.GetHeader(); }
+    int GetEndTime() const { return endTime; }
+    size_t GetNumKeyframes() const { return keyframes.size(); }
+
+    // Move to a time: the state then reflects every event at or before it.
+    // Moving forward replays incrementally; moving back goes through a keyframe
+    void SeekTo(int time);
+    int GetTime() const { return currTime; }
+    const ElevatorReplayState& GetState() const { return state; }
+
+private:
+    struct Keyframe
+    {
+        int time;                    // state holds every event before this time
+        uint64_t record;             // index of the first record at or after time
+        ElevatorReplayState state;
+    };
+
+    void restoreKeyframe(int time);
+    void playForward(int time);
+
+    ElevatorEventLogReader reader;
+    std::vector<Keyframe> keyframes;
+    int keyframeInterval;
+    int endTime;
+
+    ElevatorReplayState state;
+    int currTime;
+    ElevatorEventRecord pending;   // record read ahead of currTime
+    bool hasPending;
+};
+
+#endif
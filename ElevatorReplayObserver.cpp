@@ -0,0 +1,179 @@
+#include "ElevatorReplayObserver.h"
+#include "ElevatorLayout.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+
+using namespace ElevatorLayout;
+
+namespace {
+	const double FRAMES_PER_SECOND = 60.0;
+	const double MIN_SPEED = 0.125;
+	const double MAX_SPEED = 4096.0;
+	const int TIMELINE_MARGIN = 20;   //distance of the timeline bar from the window edges
+	const int TIMELINE_H = 16;        //height of the timeline bar
+}
+
+ElevatorReplayObserver::ElevatorReplayObserver(ECGraphicViewImp& displayManager, ElevatorReplay& replay) : displayManager(displayManager),
+	replayRef(replay),
+	floorCount(replay.GetHeader().numFloors),
+	playTime(std::max(0, replay.GetTime())),
+	speed(1.0),
+	isPaused(false),
+	isReversed(false),
+	positionOffset(0.0)
+	{
+	}
+
+void ElevatorReplayObserver::Update() {
+	ECGVEventType currentEvent = displayManager.GetCurrEvent();
+	if (currentEvent == ECGV_EV_TIMER) {
+		Advance();
+		replayRef.SeekTo((int)std::floor(playTime));
+
+		// Smooth movement (faster playback catches up faster)
+		double targetPos = std::max(0, replayRef.GetState().floor - 1);
+		double step = 0.02 * std::max(1.0, speed);
+		if (std::abs(positionOffset - targetPos) <= step) {
+			positionOffset = targetPos;
+		}
+		else {
+			positionOffset += (positionOffset < targetPos) ? step : -step;
+		}
+
+		RenderShaft();
+		RenderFloors();
+		RenderElevator();
+		RenderStatus();
+		displayManager.SetRedraw(true);
+	}
+
+	ProcessInputs(currentEvent);
+}
+
+void ElevatorReplayObserver::Advance() {
+	if (isPaused) return;
+
+	double delta = speed / FRAMES_PER_SECOND;
+	playTime += isReversed ? -delta : delta;
+	playTime = std::max(0.0, std::min(playTime, (double)replayRef.GetEndTime()));
+}
+
+void ElevatorReplayObserver::RenderShaft() {
+	//fill background color
+	displayManager.DrawFilledRectangle(0, 0, displayManager.GetWidth(), displayManager.GetHeight(), ECGV_YELLOW);
+
+	//draw white interior of shaft with black outline
+	int bottomBoundary = ELEVATOR_Y + (floorCount * FLOOR_HEIGHT);
+	displayManager.DrawFilledRectangle(ELEVATOR_X, ELEVATOR_Y, ELEVATOR_X + ELEVATOR_W, bottomBoundary, ECGV_WHITE);
+	displayManager.DrawRectangle(ELEVATOR_X, ELEVATOR_Y, ELEVATOR_X + ELEVATOR_W, bottomBoundary, 3, ECGV_BLACK);
+}
+
+void ElevatorReplayObserver::RenderFloors() {
+	const ElevatorReplayState& state = replayRef.GetState();
+	int rightBoundary = ELEVATOR_X + ELEVATOR_W;
+	int bottomBoundary = ELEVATOR_Y + (floorCount * FLOOR_HEIGHT);
+
+	for (int i = 0; i <= floorCount; i++) {
+		int currHeight = bottomBoundary - (i * FLOOR_HEIGHT);
+		displayManager.DrawLine(ELEVATOR_X, currHeight, rightBoundary, currHeight, 2, ECGV_BLACK);
+		if (i == floorCount) break;
+
+		//hall buttons and the passengers waiting on this floor
+		int indicatorY = currHeight - FLOOR_HEIGHT / 2;
+		bool upPressed = false, downPressed = false;
+		int drawnCount = 0;
+		for (const auto& p : state.waiting) {
+			if (p.floorSrc != i + 1) continue;
+			if (p.floorDest > p.floorSrc) upPressed = true;
+			else downPressed = true;
+			DrawPassenger(displayManager, rightBoundary + 45 + (drawnCount * 20), indicatorY, p.floorDest);
+			drawnCount++;
+		}
+
+		if (upPressed) displayManager.DrawFilledCircle(rightBoundary + 20, indicatorY - 10, 8, ECGV_GREEN);
+		else displayManager.DrawCircle(rightBoundary + 20, indicatorY - 10, 8, 2, ECGV_BLACK);
+		if (downPressed) displayManager.DrawFilledCircle(rightBoundary + 20, indicatorY + 10, 8, ECGV_GREEN);
+		else displayManager.DrawCircle(rightBoundary + 20, indicatorY + 10, 8, 2, ECGV_BLACK);
+	}
+}
+
+void ElevatorReplayObserver::RenderElevator() {
+	const ElevatorReplayState& state = replayRef.GetState();
+	int bottomBoundary = ELEVATOR_Y + (floorCount * FLOOR_HEIGHT);
+	int position = bottomBoundary - (int)(positionOffset * FLOOR_HEIGHT);
+
+	//cabin turns red while the car is out of service
+	int marginSize = 5;
+	displayManager.DrawFilledRectangle(
+		ELEVATOR_X + marginSize,
+		position - FLOOR_HEIGHT + 5,
+		ELEVATOR_X + ELEVATOR_W - marginSize,
+		position,
+		state.inMaintenance ? ECGV_RED : ECGV_CYAN
+	);
+
+	int sectionWidth = (ELEVATOR_W - (marginSize * 2)) / 5;
+	for (size_t i = 0; i < state.riding.size(); i++) {
+		int passengerX = ELEVATOR_X + marginSize + (sectionWidth * (int)i) + (sectionWidth / 2);
+		DrawPassenger(displayManager, passengerX, position - FLOOR_HEIGHT / 2, state.riding[i].floorDest);
+	}
+}
+
+void ElevatorReplayObserver::RenderStatus() {
+	int rightBoundary = ELEVATOR_X + ELEVATOR_W;
+
+	std::string displayTime = "Time: " + std::to_string(replayRef.GetTime());
+	displayManager.DrawText(rightBoundary + 140, 90, displayTime.c_str(), ECGV_BLACK);
+
+	std::ostringstream status;
+	status << (isPaused ? "Paused" : (isReversed ? "<< " : ">> ")) << speed << "x";
+	displayManager.DrawText(rightBoundary + 140, 120, status.str().c_str(), ECGV_BLACK);
+
+	//timeline bar with a marker for the current position
+	int left = TIMELINE_MARGIN, right = displayManager.GetWidth() - TIMELINE_MARGIN;
+	int bottom = displayManager.GetHeight() - TIMELINE_MARGIN, top = bottom - TIMELINE_H;
+	displayManager.DrawFilledRectangle(left, top, right, bottom, ECGV_WHITE);
+	displayManager.DrawRectangle(left, top, right, bottom, 2, ECGV_BLACK);
+	int endTime = std::max(1, replayRef.GetEndTime());
+	int markerX = left + (int)((right - left) * (playTime / endTime));
+	displayManager.DrawFilledRectangle(markerX - 2, top - 4, markerX + 2, bottom + 4, ECGV_BLUE);
+}
+
+void ElevatorReplayObserver::ProcessInputs(ECGVEventType currentEvent) {
+	switch (currentEvent) {
+	case ECGV_EV_KEY_DOWN_SPACE:
+		isPaused = !isPaused;
+		break;
+	case ECGV_EV_KEY_DOWN_RIGHT:
+		isReversed = false;
+		isPaused = false;
+		break;
+	case ECGV_EV_KEY_DOWN_LEFT:
+		isReversed = true;
+		isPaused = false;
+		break;
+	case ECGV_EV_KEY_DOWN_UP:
+		speed = std::min(MAX_SPEED, speed * 2);
+		break;
+	case ECGV_EV_KEY_DOWN_DOWN:
+		speed = std::max(MIN_SPEED, speed / 2);
+		break;
+	case ECGV_EV_MOUSE_BUTTON_DOWN: {
+		//seek by clicking on the timeline bar
+		int cx, cy;
+		displayManager.GetCursorPosition(cx, cy);
+		int left = TIMELINE_MARGIN, right = displayManager.GetWidth() - TIMELINE_MARGIN;
+		int bottom = displayManager.GetHeight() - TIMELINE_MARGIN, top = bottom - TIMELINE_H;
+		if (cx >= left && cx <= right && cy >= top - 4 && cy <= bottom + 4) {
+			playTime = (double)(cx - left) / (right - left) * replayRef.GetEndTime();
+			replayRef.SeekTo((int)playTime);
+			positionOffset = std::max(0, replayRef.GetState().floor - 1);
+		}
+		break;
+	}
+	default:
+		break;
+	}
+}
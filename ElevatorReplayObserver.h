@@ -0,0 +1,37 @@
+#pragma once
+#ifndef ElevatorReplayObserver_h
+#define ElevatorReplayObserver_h
+
+#include "ECObserver.h"
+#include "ECGraphicViewImp.h"
+#include "ElevatorReplay.h"
+
+//Plays back a recorded event log instead of a live simulation
+//  space: pause/resume, right: play forward, left: play in reverse
+//  up/down: double/halve playback speed, click on the timeline bar: seek
+class ElevatorReplayObserver : public ECObserver {
+public:
+	ElevatorReplayObserver(ECGraphicViewImp& displayManager, ElevatorReplay& replay);
+	virtual void Update();
+	virtual ECEventMask GetEventMask() const { return ECGV_MASK_TIMER | ECGV_MASK_KEY_DOWN | ECGV_MASK_MOUSE_BUTTONS; }
+
+private:
+	ECGraphicViewImp& displayManager;
+	ElevatorReplay& replayRef;
+
+	int floorCount;  //number of floors in the Elevator display
+	double playTime;   //current playback position (simulation time)
+	double speed;      //simulation time units per second
+	bool isPaused;
+	bool isReversed;
+	double positionOffset;   //used for fluid movement
+
+	void Advance();  //moves playTime according to speed and direction
+	void RenderShaft();
+	void RenderFloors();   //floor lines, hall buttons and waiting passengers
+	void RenderElevator();  //the cabin and its riders
+	void RenderStatus();   //time, speed and the timeline bar
+	void ProcessInputs(ECGVEventType currentEvent);
+};
+
+#endif
@@ -0,0 +1,166 @@
+#include "ElevatorReport.h"
+#include "ElevatorRequestPool.h"
+#include "ElevatorStrategyRegistry.h"
+#include "ElevatorParking.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+ElevatorRunReport BuildRunReport(const ECElevatorSim& sim, const ElevatorEnergyModel& energy) {
+    ElevatorRunReport report;
+    report.strategy = sim.GetDispatchStrategy().getName();
+    if (sim.GetParkingStrategy() != NULL) {
+        report.parking = sim.GetParkingStrategy()->getName();
+    }
+
+    report.motion = sim.GetMotionStats();
+    report.regenerative = energy.IsRegenerative();
+    report.energyConsumed = energy.Consumed(report.motion);
+    report.energyRecovered = energy.Recovered(report.motion);
+    report.energyNet = energy.Net(report.motion);
+
+    // serviced requests may already be retired, so the waits come from the summary
+    const ElevatorWaitSummary& waits = sim.GetWaitSummary();
+    report.numRequests = sim.GetNumPassengerRequests();
+    report.numServiced = (int)waits.GetCount();
+    report.numWithdrawn = sim.GetNumWithdrawn();
+    report.avgWait = waits.GetAverage();
+    report.p99Wait = waits.GetPercentile(0.99);
+    report.maxWait = waits.GetMax();
+    report.peakActiveRequests = (int)sim.GetPeakActiveRequests();
+    return report;
+}
+
+ElevatorRunReport RunHeadless(const ElevatorTrace& trace, const ElevatorRunOptions& options) {
+    ECElevatorSim simulator(trace.numFloors, trace.requests, ElevatorStrategyRegistry::Instance().Create(options.strategy));
+    simulator.SetEventLog(options.eventLog);
+    simulator.SetParkingStrategy(CreateParkingStrategy(options.parking, trace.numFloors, options.parkingParams));
+    for (int t = 0; t < trace.lenSim; ++t) {
+        simulator.Simulate(t);
+    }
+
+    ElevatorRunReport report = BuildRunReport(simulator, options.energy);
+    report.strategy = options.strategy;
+    return report;
+}
+
+std::vector<ElevatorRunReport> CompareStrategies(const ElevatorTrace& trace, const std::vector<std::string>& strategies,
+    const ElevatorRunOptions& options) {
+    std::vector<ElevatorRunReport> reports;
+    for (const auto& name : strategies) {
+        ElevatorRunOptions run = options;
+        run.strategy = name;
+        run.eventLog = NULL;
+        reports.push_back(RunHeadless(trace, run));
+    }
+
+    std::stable_sort(reports.begin(), reports.end(), [](const ElevatorRunReport& a, const ElevatorRunReport& b) {
+        int unservedA = a.numRequests - a.numServiced, unservedB = b.numRequests - b.numServiced;
+        if (unservedA != unservedB) return unservedA < unservedB;
+        if (a.avgWait != b.avgWait) return a.avgWait < b.avgWait;
+        return a.p99Wait < b.p99Wait;
+    });
+    return reports;
+}
+
+std::vector<ElevatorRunReport> CompareParking(const ElevatorTrace& trace, const ElevatorRunOptions& options) {
+    std::vector<ElevatorRunReport> reports;
+    for (const auto& name : GetParkingStrategyNames()) {
+        ElevatorRunOptions run = options;
+        run.parking = name;
+        run.eventLog = NULL;
+        reports.push_back(RunHeadless(trace, run));
+    }
+    return reports;
+}
+
+ElevatorRunReport MergeRunReports(const std::vector<ElevatorRunReport>& reports,
+    const std::vector<ElevatorWaitSummary>& waits, const ElevatorEnergyModel& energy) {
+    ElevatorRunReport total;
+    ElevatorWaitSummary allWaits;
+    for (size_t i = 0; i < reports.size(); ++i) {
+        const ElevatorRunReport& r = reports[i];
+        total.numRequests += r.numRequests;
+        total.numServiced += r.numServiced;
+        total.numWithdrawn += r.numWithdrawn;
+        total.peakActiveRequests += r.peakActiveRequests;
+        total.motion.Add(r.motion);
+        if (i < waits.size()) {
+            allWaits.Merge(waits[i]);
+        }
+    }
+    total.avgWait = allWaits.GetAverage();
+    total.p99Wait = allWaits.GetPercentile(0.99);
+    total.maxWait = allWaits.GetMax();
+    total.regenerative = energy.IsRegenerative();
+    total.energyConsumed = energy.Consumed(total.motion);
+    total.energyRecovered = energy.Recovered(total.motion);
+    total.energyNet = energy.Net(total.motion);
+    return total;
+}
+
+void PrintRunReport(std::ostream& out, const ElevatorRunReport& report) {
+    out << "Strategy: " << report.strategy << "\n"
+        << "Requests serviced: " << report.numServiced << " / " << report.numRequests << "\n";
+    if (report.numWithdrawn > 0) {
+        out << "Requests withdrawn: " << report.numWithdrawn << "\n";
+    }
+    out
+        << "Average wait: " << std::fixed << std::setprecision(2) << report.avgWait << "\n"
+        << "p99 wait: " << report.p99Wait << "\n"
+        << "Max wait: " << report.maxWait << "\n"
+        << "Peak active requests: " << report.peakActiveRequests << "\n"
+        << "Floors traveled: " << report.motion.GetFloorsTraveled()
+        << " (up " << report.motion.floorsUp << ", down " << report.motion.floorsDown << ")\n"
+        << "Starts: " << report.motion.starts << ", stops: " << report.motion.stops
+        << ", reversals: " << report.motion.reversals << "\n"
+        << "Moving/dwell/idle steps: " << report.motion.movingTicks << " / " << report.motion.dwellTicks
+        << " / " << report.motion.idleTicks << "\n";
+    if (report.parking != "none") {
+        out << "Parking: " << report.parking << ", " << report.motion.parkingTicks << " steps repositioning\n";
+    }
+    out
+        << "Out of service: " << report.motion.maintenanceTicks << " steps in "
+        << report.motion.maintenancePeriods << " maintenance period(s)\n"
+        << "Energy: " << report.energyNet;
+    if (report.regenerative) {
+        out << " (consumed " << report.energyConsumed << ", recovered " << report.energyRecovered << ")";
+    }
+    out << std::endl;
+}
+
+void PrintComparison(std::ostream& out, const std::vector<ElevatorRunReport>& reports) {
+    out << std::left << std::setw(6) << "Rank" << std::setw(14) << "Strategy"
+        << std::right << std::setw(10) << "Serviced" << std::setw(10) << "Avg wait"
+        << std::setw(10) << "p99 wait" << std::setw(10) << "Max wait"
+        << std::setw(8) << "Floors" << std::setw(7) << "Stops" << std::setw(7) << "Revs" << std::setw(10) << "Energy" << "\n";
+    for (size_t i = 0; i < reports.size(); ++i) {
+        const ElevatorRunReport& r = reports[i];
+        std::string serviced = std::to_string(r.numServiced) + "/" + std::to_string(r.numRequests);
+        out << std::left << std::setw(6) << (i + 1) << std::setw(14) << r.strategy
+            << std::right << std::setw(10) << serviced
+            << std::setw(10) << std::fixed << std::setprecision(2) << r.avgWait
+            << std::setw(10) << r.p99Wait << std::setw(10) << r.maxWait
+            << std::setw(8) << r.motion.GetFloorsTraveled() << std::setw(7) << r.motion.stops
+            << std::setw(7) << r.motion.reversals << std::setw(10) << r.energyNet << "\n";
+    }
+    out.flush();
+}
+
+void PrintParkingComparison(std::ostream& out, const std::vector<ElevatorRunReport>& reports) {
+    out << std::left << std::setw(12) << "Parking"
+        << std::right << std::setw(10) << "Serviced" << std::setw(10) << "Avg wait" << std::setw(9) << "Change"
+        << std::setw(10) << "p99 wait" << std::setw(8) << "Floors" << std::setw(9) << "Parking" << std::setw(10) << "Energy" << "\n";
+    for (const auto& r : reports) {
+        std::string serviced = std::to_string(r.numServiced) + "/" + std::to_string(r.numRequests);
+        double base = reports.front().avgWait;
+        double change = base > 0.0 ? (r.avgWait - base) / base * 100.0 : 0.0;
+        out << std::left << std::setw(12) << r.parking
+            << std::right << std::setw(10) << serviced
+            << std::setw(10) << std::fixed << std::setprecision(2) << r.avgWait
+            << std::setw(8) << std::setprecision(1) << std::showpos << change << std::noshowpos << "%"
+            << std::setw(10) << r.p99Wait << std::setw(8) << r.motion.GetFloorsTraveled()
+            << std::setw(9) << r.motion.parkingTicks << std::setw(10) << std::setprecision(2) << r.energyNet << "\n";
+    }
+    out.flush();
+}
@@ -0,0 +1,72 @@
+#pragma once
+#ifndef ElevatorReport_h
+#define ElevatorReport_h
+
+#include "ECElevatorSim.h"
+#include "ElevatorEnergyModel.h"
+#include "ElevatorParking.h"
+#include "ElevatorTraceReader.h"
+#include "ElevatorRequestPool.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+//*****************************************************************************
+// End-of-run summary. Wait time of a request = arrive time - request time
+// Motion counters and energy cover the whole run of the car
+
+struct ElevatorRunReport
+{
+    std::string strategy;
+    std::string parking = "none";
+    int numRequests = 0;
+    int numServiced = 0;
+    int numWithdrawn = 0;         // passengers who gave up waiting
+    double avgWait = 0.0;
+    int p99Wait = 0;
+    int maxWait = 0;
+    int peakActiveRequests = 0;   // most requests held by the simulator at once
+
+    ElevatorMotionStats motion;
+    bool regenerative = false;
+    double energyConsumed = 0.0;
+    double energyRecovered = 0.0;
+    double energyNet = 0.0;
+};
+
+// How to run a trace headless
+struct ElevatorRunOptions
+{
+    std::string strategy = "default";
+    std::string parking = "none";        // idle repositioning, see ElevatorParking.h
+    ElevatorParkingParams parkingParams;
+    ElevatorEnergyModel energy;
+    ElevatorEventLog* eventLog = NULL;   // optional, must already be open
+};
+
+// Summarize the current state of a simulator
+ElevatorRunReport BuildRunReport(const ECElevatorSim& sim, const ElevatorEnergyModel& energy = ElevatorEnergyModel());
+
+// Run a copy of the trace without the UI (times 0 .. lenSim-1)
+ElevatorRunReport RunHeadless(const ElevatorTrace& trace, const ElevatorRunOptions& options);
+
+// Run every named policy on the same trace; result is ranked best first
+// (fewest unserviced requests, then average wait, then p99 wait). options.strategy is ignored
+std::vector<ElevatorRunReport> CompareStrategies(const ElevatorTrace& trace, const std::vector<std::string>& strategies,
+    const ElevatorRunOptions& options);
+
+// Run the trace with every parking policy (options.parking is ignored), "none" first
+std::vector<ElevatorRunReport> CompareParking(const ElevatorTrace& trace, const ElevatorRunOptions& options);
+
+// Totals over several cars or buildings: counters add up, waits[i] (the waits of
+// reports[i]) are merged exactly for the wait statistics
+ElevatorRunReport MergeRunReports(const std::vector<ElevatorRunReport>& reports,
+    const std::vector<ElevatorWaitSummary>& waits, const ElevatorEnergyModel& energy);
+
+void PrintRunReport(std::ostream& out, const ElevatorRunReport& report);
+void PrintComparison(std::ostream& out, const std::vector<ElevatorRunReport>& reports);
+
+// Parking policies side by side; waits are compared against the first report
+void PrintParkingComparison(std::ostream& out, const std::vector<ElevatorRunReport>& reports);
+
+#endif
@@ -0,0 +1,53 @@
+#include "ElevatorRequestPool.h"
+#include <algorithm>
+#include <cmath>
+
+// ElevatorWaitSummary Implementation
+int ElevatorWaitSummary::GetPercentile(double fraction) const {
+    if (count == 0) {
+        return 0;
+    }
+    long long rank = std::max(1LL, (long long)std::ceil(fraction * count));
+    long long seen = 0;
+    for (size_t w = 0; w < waitCounts.size(); ++w) {
+        seen += waitCounts[w];
+        if (seen >= rank) {
+            return (int)w;
+        }
+    }
+    return GetMax();
+}
+
+void ElevatorWaitSummary::Merge(const ElevatorWaitSummary& other) {
+    if (other.waitCounts.size() > waitCounts.size()) {
+        waitCounts.resize(other.waitCounts.size(), 0);
+    }
+    for (size_t w = 0; w < other.waitCounts.size(); ++w) {
+        waitCounts[w] += other.waitCounts[w];
+    }
+    count += other.count;
+    totalWait += other.totalWait;
+}
+
+// ElevatorRequestPool Implementation
+// Requests usually come in handle order (append); out-of-order ones are inserted in place
+void ElevatorRequestPool::Admit(ElevatorRequestHandle handle, const ECElevatorSimRequest& req) {
+    if (handles.empty() || handles.back() < handle) {
+        live.push_back(req);
+        handles.push_back(handle);
+    }
+    else {
+        size_t pos = std::upper_bound(handles.begin(), handles.end(), handle) - handles.begin();
+        live.insert(live.begin() + pos, req);
+        handles.insert(handles.begin() + pos, handle);
+    }
+    peakLive = std::max(peakLive, live.size());
+}
+
+const ECElevatorSimRequest* ElevatorRequestPool::Find(ElevatorRequestHandle handle) const {
+    auto it = std::lower_bound(handles.begin(), handles.end(), handle);
+    if (it == handles.end() || *it != handle) {
+        return NULL;
+    }
+    return &live[it - handles.begin()];
+}
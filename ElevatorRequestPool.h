@@ -0,0 +1,112 @@
+#pragma once
+#ifndef ElevatorRequestPool_h
+#define ElevatorRequestPool_h
+
+#include "ECElevatorSim.h"
+#include <cstdint>
+#include <vector>
+
+//*****************************************************************************
+// Summary of serviced requests: exact wait time histogram, so the report does
+// not need the serviced records themselves
+
+class ElevatorWaitSummary
+{
+public:
+    ElevatorWaitSummary() : count(0), totalWait(0) {}
+
+    void Add(int wait)
+    {
+        if (wait < 0) wait = 0;
+        if ((size_t)wait >= waitCounts.size()) {
+            waitCounts.resize(wait + 1, 0);
+        }
+        waitCounts[wait]++;
+        count++;
+        totalWait += wait;
+    }
+
+    long long GetCount() const { return count; }
+    double GetAverage() const { return count > 0 ? (double)totalWait / count : 0.0; }
+    int GetMax() const { return waitCounts.empty() ? 0 : (int)waitCounts.size() - 1; }
+
+    // nearest-rank percentile (fraction in (0, 1])
+    int GetPercentile(double fraction) const;
+
+    // Add all waits of another summary (exact, percentiles stay exact)
+    void Merge(const ElevatorWaitSummary& other);
+
+private:
+    long long count;
+    long long totalWait;
+    std::vector<long long> waitCounts;   // waitCounts[w] = requests that waited w
+};
+
+//*****************************************************************************
+// Live set of requests: requests that have been made and are not retired yet.
+// Records sit contiguously, ordered by handle (= the order of the input list,
+// which the simulation rules depend on). Serviced records are retired and
+// dropped by Compact(); the live and spare vectors trade places and keep their
+// capacity, so freed slots are reused by later requests and memory follows the
+// number of active requests
+
+class ElevatorRequestPool
+{
+public:
+    ElevatorRequestPool() : numRetired(0), peakLive(0) {}
+
+    // Add a request that has just been made (handles survive compaction, unlike pointers)
+    void Admit(ElevatorRequestHandle handle, const ECElevatorSimRequest& req);
+
+    // Mark a live record as done; it stays visible (as serviced) until Compact()
+    void Retire() { numRetired++; }
+
+    // Worth compacting: retired records make up a large share of the live set
+    bool NeedsCompaction() const { return numRetired >= 16 && numRetired * 2 >= live.size(); }
+
+    // Drop retired records, calling onRemove(handle, record) for each; keeps order
+    template <class Callback>
+    void Compact(Callback onRemove)
+    {
+        //kept records are copied into the spare vector, which then becomes the live set
+        //(requests have no assignment operator to shift them in place with)
+        spare.clear();
+        size_t out = 0;
+        for (size_t i = 0; i < live.size(); ++i) {
+            if (live[i].IsServiced()) {
+                onRemove(handles[i], live[i]);
+                continue;
+            }
+            spare.push_back(live[i]);
+            handles[out++] = handles[i];
+        }
+        live.swap(spare);
+        handles.erase(handles.begin() + out, handles.end());
+        numRetired = 0;
+    }
+
+    std::vector<ECElevatorSimRequest>& GetLive() { return live; }
+    const std::vector<ECElevatorSimRequest>& GetLive() const { return live; }
+
+    // Handle of a record in the live set
+    ElevatorRequestHandle GetHandle(const ECElevatorSimRequest& req) const { return handles[&req - live.data()]; }
+
+    // Record for a handle, NULL if it is not (or no longer) live
+    const ECElevatorSimRequest* Find(ElevatorRequestHandle handle) const;
+    ECElevatorSimRequest* Find(ElevatorRequestHandle handle)
+    {
+        return const_cast<ECElevatorSimRequest*>(static_cast<const ElevatorRequestPool*>(this)->Find(handle));
+    }
+
+    size_t GetNumLive() const { return live.size(); }
+    size_t GetPeakLive() const { return peakLive; }
+
+private:
+    std::vector<ECElevatorSimRequest> live;
+    std::vector<ECElevatorSimRequest> spare;      // the next live set, built by Compact
+    std::vector<ElevatorRequestHandle> handles;   // parallel to live, ascending
+    size_t numRetired;
+    size_t peakLive;
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "ElevatorStrategyRegistry.h"
+
+using namespace std;
+
+// Direction that gets the car from currFloor to targetFloor
+static EC_ELEVATOR_DIR directionTowards(int currFloor, int targetFloor) {
+    if (targetFloor == -1 || targetFloor == currFloor) {
+        return EC_ELEVATOR_STOPPED;
+    }
+    return (targetFloor > currFloor) ? EC_ELEVATOR_UP : EC_ELEVATOR_DOWN;
+}
+
+// ScanDispatchStrategy Implementation
+// Keep sweeping to the end of the shaft as long as anything is outstanding
+EC_ELEVATOR_DIR ScanDispatchStrategy::chooseDirection(const ECElevatorSim& sim, int currTime) const {
+    int currFloor = sim.GetCurrFloor();
+    int target = sim.GetNearestRequestFloor(currTime);
+    if (target == -1) {
+        return EC_ELEVATOR_STOPPED;
+    }
+
+    switch (sim.GetCurrDir()) {
+    case EC_ELEVATOR_UP:
+        return (currFloor < sim.GetNumFloors()) ? EC_ELEVATOR_UP : EC_ELEVATOR_DOWN;
+    case EC_ELEVATOR_DOWN:
+        return (currFloor > 1) ? EC_ELEVATOR_DOWN : EC_ELEVATOR_UP;
+    default:
+        return directionTowards(currFloor, target);
+    }
+}
+
+// LookDispatchStrategy Implementation
+// Continue while there is something ahead, reverse if there is something behind
+EC_ELEVATOR_DIR LookDispatchStrategy::chooseDirection(const ECElevatorSim& sim, int currTime) const {
+    int currFloor = sim.GetCurrFloor();
+    bool above = sim.HasRequestsAbove(currFloor, currTime);
+    bool below = sim.HasRequestsBelow(currFloor, currTime);
+
+    if (sim.GetCurrDir() == EC_ELEVATOR_UP) {
+        if (above) return EC_ELEVATOR_UP;
+        if (below) return EC_ELEVATOR_DOWN;
+    }
+    else if (sim.GetCurrDir() == EC_ELEVATOR_DOWN) {
+        if (below) return EC_ELEVATOR_DOWN;
+        if (above) return EC_ELEVATOR_UP;
+    }
+    return directionTowards(currFloor, sim.GetNearestRequestFloor(currTime));
+}
+
+// NearestCallDispatchStrategy Implementation
+EC_ELEVATOR_DIR NearestCallDispatchStrategy::chooseDirection(const ECElevatorSim& sim, int currTime) const {
+    return directionTowards(sim.GetCurrFloor(), sim.GetNearestRequestFloor(currTime));
+}
+
+// CollectiveDispatchStrategy Implementation
+// A stopped car takes anyone; a moving car only picks up passengers going its way
+bool CollectiveDispatchStrategy::acceptsPickup(const ECElevatorSimRequest& req, EC_ELEVATOR_DIR currDir) const {
+    if (currDir == EC_ELEVATOR_STOPPED) {
+        return true;
+    }
+    return req.IsGoingUp() == (currDir == EC_ELEVATOR_UP);
+}
+
+// ElevatorStrategyRegistry Implementation
+ElevatorStrategyRegistry& ElevatorStrategyRegistry::Instance() {
+    static ElevatorStrategyRegistry registry;
+    return registry;
+}
+
+// Constructor, registers the built-in policies
+ElevatorStrategyRegistry::ElevatorStrategyRegistry() {
+    Register("default", "continue while requests are ahead, else serve the earliest request", [] { return new DefaultDispatchStrategy(); });
+    Register("scan", "sweep to the end of the shaft before reversing", [] { return new ScanDispatchStrategy(); });
+    Register("look", "sweep to the last request before reversing", [] { return new LookDispatchStrategy(); });
+    Register("nearest", "always serve the closest requested floor", [] { return new NearestCallDispatchStrategy(); });
+    Register("collective", "LOOK sweeps, hall calls answered in their travel direction", [] { return new CollectiveDispatchStrategy(); });
+}
+
+bool ElevatorStrategyRegistry::Register(const std::string& name, const std::string& description, Factory factory) {
+    if (entries.count(name) > 0) {
+        return false;
+    }
+    entries[name] = Entry{ description, factory };
+    return true;
+}
+
+ElevatorDispatchStrategy* ElevatorStrategyRegistry::Create(const std::string& name) const {
+    auto it = entries.find(name);
+    if (it == entries.end()) {
+        return NULL;
+    }
+    return it->second.factory();
+}
+
+std::vector<std::string> ElevatorStrategyRegistry::GetNames() const {
+    std::vector<std::string> names;
+    for (const auto& entry : entries) {
+        names.push_back(entry.first);
+    }
+    return names;
+}
+
+std::string ElevatorStrategyRegistry::GetDescription(const std::string& name) const {
+    auto it = entries.find(name);
+    return (it != entries.end()) ? it->second.description : std::string();
+}
@@ -0,0 +1,89 @@
+#pragma once
+#ifndef ElevatorStrategyRegistry_h
+#define ElevatorStrategyRegistry_h
+
+#include "ECElevatorSim.h"
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+//*****************************************************************************
+// Built-in dispatch policies
+
+// SCAN: sweep all the way to the top/bottom floor before reversing
+class ScanDispatchStrategy : public ElevatorDispatchStrategy
+{
+public:
+    const char* getName() const override { return "scan"; }
+    EC_ELEVATOR_DIR chooseDirection(const ECElevatorSim& sim, int currTime) const override;
+};
+
+// LOOK: sweep only as far as the last request, then reverse
+class LookDispatchStrategy : public ElevatorDispatchStrategy
+{
+public:
+    const char* getName() const override { return "look"; }
+    EC_ELEVATOR_DIR chooseDirection(const ECElevatorSim& sim, int currTime) const override;
+};
+
+// Nearest call: always head for the closest requested floor
+class NearestCallDispatchStrategy : public ElevatorDispatchStrategy
+{
+public:
+    const char* getName() const override { return "nearest"; }
+    EC_ELEVATOR_DIR chooseDirection(const ECElevatorSim& sim, int currTime) const override;
+};
+
+// Collective control: LOOK sweeps, but hall calls are only answered in their travel direction
+class CollectiveDispatchStrategy : public LookDispatchStrategy
+{
+public:
+    const char* getName() const override { return "collective"; }
+    bool acceptsPickup(const ECElevatorSimRequest& req, EC_ELEVATOR_DIR currDir) const override;
+};
+
+//*****************************************************************************
+// Registry of dispatch policies by name. Built-in policies are always there;
+// user policies can be added with Register (or a static ElevatorStrategyRegistrar)
+
+class ElevatorStrategyRegistry
+{
+public:
+    typedef std::function<ElevatorDispatchStrategy*()> Factory;
+
+    static ElevatorStrategyRegistry& Instance();
+
+    // Add a policy; returns false if the name is already taken
+    bool Register(const std::string& name, const std::string& description, Factory factory);
+
+    // Create a new policy (caller owns it); NULL if the name is unknown
+    ElevatorDispatchStrategy* Create(const std::string& name) const;
+
+    bool Contains(const std::string& name) const { return entries.count(name) > 0; }
+    std::vector<std::string> GetNames() const;
+    std::string GetDescription(const std::string& name) const;
+
+private:
+    ElevatorStrategyRegistry();
+
+    struct Entry
+    {
+        std::string description;
+        Factory factory;
+    };
+    std::map<std::string, Entry> entries;
+};
+
+// Registers a user policy at static-init time, e.g.
+//   static ElevatorStrategyRegistrar reg("mine", "my policy", [] { return new MyStrategy(); });
+class ElevatorStrategyRegistrar
+{
+public:
+    ElevatorStrategyRegistrar(const std::string& name, const std::string& description, ElevatorStrategyRegistry::Factory factory)
+    {
+        ElevatorStrategyRegistry::Instance().Register(name, description, factory);
+    }
+};
+
+#endif
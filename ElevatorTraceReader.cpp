@@ -0,0 +1,153 @@
+#include "ElevatorTraceReader.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+// Chunks smaller than this aren't worth a thread
+static const size_t MIN_CHUNK_BYTES = 1 << 20;
+
+// ParseInt helper function, reads one integer the way "stream >> int" does
+// (leading blanks, optional sign, digits; out of range fails); stops at end
+static bool ParseInt(const char*& p, const char* end, int& value) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\v' || *p == '\f')) {
+        ++p;
+    }
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        ++p;
+    }
+    if (p == end || *p < '0' || *p > '9') {
+        return false;
+    }
+
+    long long result = 0;
+    bool overflow = false;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+        result = result * 10 + (*p - '0');
+        if (result > (long long)INT_MAX + 1) {
+            overflow = true;
+            result = (long long)INT_MAX + 1;
+        }
+    }
+    if (negative) result = -result;
+    if (overflow || result > INT_MAX || result < INT_MIN) {
+        value = result < 0 ? INT_MIN : INT_MAX;
+        return false;
+    }
+    value = (int)result;
+    return true;
+}
+
+// ParseRequests helper function, every request line in [begin, end) (whole lines only)
+static void ParseRequests(const char* begin, const char* end, std::vector<ECElevatorSimRequest>& requests) {
+    const char* line = begin;
+    while (line < end) {
+        const char* eol = (const char*)memchr(line, '\n', end - line);
+        if (eol == NULL) eol = end;
+
+        //skip comments, blank and malformed lines
+        int passengerAppearanceTime, originalFloor, destinationFloor;
+        const char* p = line;
+        if (line < eol && *line != '#' &&
+            ParseInt(p, eol, passengerAppearanceTime) && ParseInt(p, eol, originalFloor) && ParseInt(p, eol, destinationFloor)) {
+            requests.push_back(ECElevatorSimRequest(passengerAppearanceTime, originalFloor, destinationFloor));
+        }
+        line = eol + 1;
+    }
+}
+
+// NextLine helper function, start of the line after pos (end if none)
+static const char* NextLine(const char* pos, const char* end) {
+    const char* eol = (const char*)memchr(pos, '\n', end - pos);
+    return eol == NULL ? end : eol + 1;
+}
+
+void ParseElevatorTrace(const char* data, size_t size, ElevatorTrace& trace, int numThreads) {
+    const char* end = data + size;
+
+    //first line that isn't a comment has the floors + time to simulate
+    const char* body = data;
+    while (body < end) {
+        const char* next = NextLine(body, end);
+        if (*body != '#') {
+            const char* p = body;
+            if (ParseInt(p, next, trace.numFloors)) {
+                ParseInt(p, next, trace.lenSim);
+            }
+            body = next;
+            break;
+        }
+        body = next;
+    }
+
+    //newline-aligned chunks, one per thread
+    size_t bodySize = end - body;
+    if (numThreads <= 0) {
+        numThreads = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    size_t numChunks = std::max<size_t>(1, std::min<size_t>(numThreads, bodySize / MIN_CHUNK_BYTES));
+
+    std::vector<const char*> bounds(numChunks + 1, end);
+    bounds[0] = body;
+    for (size_t k = 1; k < numChunks; ++k) {
+        const char* guess = body + bodySize / numChunks * k;
+        bounds[k] = std::max(bounds[k - 1], NextLine(std::max(guess - 1, body), end));
+    }
+
+    if (numChunks == 1) {
+        ParseRequests(body, end, trace.requests);
+        return;
+    }
+
+    std::vector<std::vector<ECElevatorSimRequest>> parts(numChunks);
+    std::vector<std::thread> threads;
+    for (size_t k = 1; k < numChunks; ++k) {
+        threads.emplace_back(ParseRequests, bounds[k], bounds[k + 1], std::ref(parts[k]));
+    }
+    ParseRequests(bounds[0], bounds[1], parts[0]);
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    //merge in file order
+    size_t total = trace.requests.size();
+    for (const auto& part : parts) {
+        total += part.size();
+    }
+    trace.requests.reserve(total);
+    for (auto& part : parts) {
+        trace.requests.insert(trace.requests.end(), part.begin(), part.end());
+        std::vector<ECElevatorSimRequest>().swap(part);
+    }
+}
+
+bool LoadElevatorTrace(const std::string& path, ElevatorTrace& trace, int numThreads) {
+    std::ifstream fileStream(path, std::ios::binary);
+    if (!fileStream.is_open()) {
+        return false;
+    }
+
+    //whole file in one read
+    std::string data;
+    fileStream.seekg(0, std::ios::end);
+    std::streamoff size = fileStream.tellg();
+    if (size > 0) {
+        data.resize((size_t)size);
+        fileStream.seekg(0, std::ios::beg);
+        fileStream.read(&data[0], size);
+        data.resize((size_t)fileStream.gcount());
+    }
+    else {
+        //not seekable (pipe)
+        fileStream.clear();
+        fileStream.seekg(0, std::ios::beg);
+        data.assign(std::istreambuf_iterator<char>(fileStream), std::istreambuf_iterator<char>());
+    }
+
+    ParseElevatorTrace(data.data(), data.size(), trace, numThreads);
+    return true;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#ifndef ElevatorTraceReader_h
+#define ElevatorTraceReader_h
+
+#include "ECElevatorSim.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//*****************************************************************************
+// Simulation input file:
+//   first line: <number of floors> <length of simulation>
+//   then one request per line: <time> <source floor> <destination floor>
+// Lines starting with '#' are comments; blank/malformed lines are skipped
+//
+// Large files are split into newline-aligned chunks that are parsed by worker
+// threads; the requests keep the order of the file
+
+struct ElevatorTrace
+{
+    int numFloors = 0;
+    int lenSim = 0;
+    std::vector<ECElevatorSimRequest> requests;
+};
+
+// Read a trace file; returns false if the file cannot be opened
+// numThreads: parser threads (0: one per hardware thread; small files always use one)
+bool LoadElevatorTrace(const std::string& path, ElevatorTrace& trace, int numThreads = 0);
+
+// Same for a trace already in memory
+void ParseElevatorTrace(const char* data, size_t size, ElevatorTrace& trace, int numThreads = 0);
+
+#endif
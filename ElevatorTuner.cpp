@@ -0,0 +1,440 @@
+#include "ElevatorTuner.h"
+#include "ElevatorStrategyRegistry.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <thread>
+
+// Search space: policy, parking policy, lobby floor, half-life, idle delay
+static const int NUM_DIMENSIONS = 5;
+static const double MIN_HALF_LIFE = 10.0;
+static const double MAX_HALF_LIFE = 10000.0;
+static const int HALF_LIFE_STEPS = 40;     // half-lives tried, evenly on a log scale
+static const int MAX_IDLE_DELAY = 120;
+static const int IDLE_DELAY_STEP = 2;
+
+static uint64_t HashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+template <typename T>
+static uint64_t HashValue(uint64_t hash, const T& value) {
+    return HashBytes(hash, &value, sizeof(value));
+}
+
+// ElevatorTuneSettings Implementation
+void ElevatorTuneSettings::Normalize() {
+    ElevatorParkingParams defaults;
+    if (parking != "lobby") {
+        params.lobbyFloor = defaults.lobbyFloor;
+    }
+    if (parking != "predictive") {
+        params.halfLife = defaults.halfLife;
+    }
+    if (parking == "none") {
+        params.idleDelay = defaults.idleDelay;
+    }
+}
+
+uint64_t ElevatorTuneSettings::Hash() const {
+    std::string text = Describe();
+    return HashBytes(14695981039346656037ULL, text.data(), text.size());
+}
+
+std::string ElevatorTuneSettings::Describe() const {
+    std::ostringstream oss;
+    oss << "--strategy " << strategy << " --parking " << parking;
+    ElevatorParkingParams defaults;
+    if (params.lobbyFloor != defaults.lobbyFloor) oss << " --lobby-floor " << params.lobbyFloor;
+    if (params.halfLife != defaults.halfLife) oss << " --half-life " << params.halfLife;
+    if (params.idleDelay != defaults.idleDelay) oss << " --idle-delay " << params.idleDelay;
+    return oss.str();
+}
+
+// Everything besides the settings that a result depends on
+static uint64_t HashRun(const ElevatorTrace& trace, const ElevatorRunOptions& options, const ElevatorTuneOptions& tune) {
+    uint64_t hash = 14695981039346656037ULL;
+    hash = HashValue(hash, trace.numFloors);
+    hash = HashValue(hash, trace.lenSim);
+    for (const auto& req : trace.requests) {
+        hash = HashValue(hash, req.GetTime());
+        hash = HashValue(hash, req.GetFloorSrc());
+        hash = HashValue(hash, req.GetFloorDest());
+    }
+    const ElevatorEnergyModel& energy = options.energy;
+    for (double v : { energy.perFloorUp, energy.perFloorDown, energy.perStart, energy.perStandingTick, energy.regenEfficiency,
+                      tune.checkFraction, tune.stopMargin }) {
+        hash = HashValue(hash, v);
+    }
+    return hash;
+}
+
+// A point of the unit cube as settings
+static ElevatorTuneSettings Decode(const double* x, const std::vector<std::string>& strategies, int numFloors) {
+    auto pick = [](double v, int n) { return std::min(n - 1, std::max(0, (int)(v * n))); };
+    const std::vector<std::string>& parkings = GetParkingStrategyNames();
+
+    ElevatorTuneSettings settings;
+    settings.strategy = strategies[pick(x[0], (int)strategies.size())];
+    settings.parking = parkings[pick(x[1], (int)parkings.size())];
+    settings.params.lobbyFloor = 1 + pick(x[2], numFloors);
+    double step = std::round(x[3] * HALF_LIFE_STEPS) / HALF_LIFE_STEPS;
+    settings.params.halfLife = std::round(MIN_HALF_LIFE * std::pow(MAX_HALF_LIFE / MIN_HALF_LIFE, step));
+    settings.params.idleDelay = IDLE_DELAY_STEP * (int)std::round(x[4] * MAX_IDLE_DELAY / IDLE_DELAY_STEP);
+    settings.Normalize();
+    return settings;
+}
+
+static bool IsFeasible(const ElevatorTuneResult& r, const ElevatorTuneResult& baseline) {
+    return r.complete && r.numRequests - r.numServiced <= baseline.numRequests - baseline.numServiced;
+}
+
+static bool Dominates(const ElevatorTuneResult& a, const ElevatorTuneResult& b) {
+    return a.p99Wait <= b.p99Wait && a.energy <= b.energy && (a.p99Wait < b.p99Wait || a.energy < b.energy);
+}
+
+// Non-dominated results, lowest p99 first (one per distinct point)
+static std::vector<ElevatorTuneResult> ParetoFront(const std::vector<ElevatorTuneResult>& results) {
+    std::vector<ElevatorTuneResult> sorted = results;
+    std::stable_sort(sorted.begin(), sorted.end(), [](const ElevatorTuneResult& a, const ElevatorTuneResult& b) {
+        return a.p99Wait != b.p99Wait ? a.p99Wait < b.p99Wait : a.energy < b.energy;
+    });
+    std::vector<ElevatorTuneResult> front;
+    for (const auto& r : sorted) {
+        if (front.empty() || r.energy < front.back().energy) {
+            front.push_back(r);
+        }
+    }
+    return front;
+}
+
+// One run; stopped at the checkpoint if a point of the front was clearly better there
+static ElevatorTuneResult Evaluate(const ElevatorTrace& trace, const ElevatorRunOptions& options, const ElevatorTuneOptions& tune,
+    const ElevatorTuneSettings& settings, const std::vector<ElevatorTuneResult>& front) {
+    ECElevatorSim simulator(trace.numFloors, trace.requests, ElevatorStrategyRegistry::Instance().Create(settings.strategy));
+    simulator.SetParkingStrategy(CreateParkingStrategy(settings.parking, trace.numFloors, settings.params));
+
+    ElevatorTuneResult result;
+    result.settings = settings;
+    int checkTime = (int)(trace.lenSim * std::min(1.0, std::max(0.0, tune.checkFraction)));
+    int t = 0;
+    for (; t < checkTime; ++t) {
+        simulator.Simulate(t);
+    }
+    ElevatorRunReport check = BuildRunReport(simulator, options.energy);
+    result.checkP99Wait = check.p99Wait;
+    result.checkEnergy = check.energyNet;
+    result.numRequests = check.numRequests;
+    for (const auto& f : front) {
+        double scale = 1.0 + tune.stopMargin;
+        if (f.checkP99Wait * scale <= result.checkP99Wait && f.checkEnergy * scale <= result.checkEnergy) {
+            return result;
+        }
+    }
+
+    for (; t < trace.lenSim; ++t) {
+        simulator.Simulate(t);
+    }
+    ElevatorRunReport report = BuildRunReport(simulator, options.energy);
+    result.complete = true;
+    result.numServiced = report.numServiced;
+    result.numRequests = report.numRequests;
+    result.p99Wait = report.p99Wait;
+    result.avgWait = report.avgWait;
+    result.energy = report.energyNet;
+    return result;
+}
+
+// Cache file: one result per line, "<key> <complete> <serviced> <requests> <p99> <avg wait> <energy>
+// <checkpoint p99> <checkpoint energy> <strategy> <parking> <lobby floor> <half-life> <idle delay>"
+static void LoadCache(const std::string& path, std::map<uint64_t, ElevatorTuneResult>& cache) {
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream iss(line);
+        std::string key;
+        ElevatorTuneResult r;
+        if (iss >> key >> r.complete >> r.numServiced >> r.numRequests >> r.p99Wait >> r.avgWait >> r.energy
+                >> r.checkP99Wait >> r.checkEnergy >> r.settings.strategy >> r.settings.parking
+                >> r.settings.params.lobbyFloor >> r.settings.params.halfLife >> r.settings.params.idleDelay) {
+            cache[std::strtoull(key.c_str(), NULL, 16)] = r;
+        }
+    }
+}
+
+static bool SaveCache(const std::string& path, const std::map<uint64_t, ElevatorTuneResult>& cache) {
+    std::ofstream file(path);
+    if (!file) return false;
+    file << "# <key> <complete> <serviced> <requests> <p99> <avg wait> <energy> <checkpoint p99> <checkpoint energy>"
+            " <strategy> <parking> <lobby floor> <half-life> <idle delay>\n";
+    file << std::setprecision(17);
+    for (const auto& entry : cache) {
+        const ElevatorTuneResult& r = entry.second;
+        char key[32];
+        snprintf(key, sizeof(key), "%016llx", (unsigned long long)entry.first);
+        file << key << " " << r.complete << " " << r.numServiced << " " << r.numRequests << " " << r.p99Wait << " "
+             << r.avgWait << " " << r.energy << " " << r.checkP99Wait << " " << r.checkEnergy << " "
+             << r.settings.strategy << " " << r.settings.parking << " " << r.settings.params.lobbyFloor << " "
+             << r.settings.params.halfLife << " " << r.settings.params.idleDelay << "\n";
+    }
+    return (bool)file;
+}
+
+// Separable CMA-ES: step size by cumulative path length, diagonal covariance by rank-mu update
+class ElevatorSepCMA
+{
+public:
+    ElevatorSepCMA(int dimensions, int lambdaIn, uint32_t seed)
+        : n(dimensions), lambda(lambdaIn), mean(dimensions, 0.5), diag(dimensions, 1.0), pathSigma(dimensions, 0.0),
+          sigma(0.3), rng(seed) {
+        mu = lambda / 2;
+        double sum = 0.0, sumSq = 0.0;
+        for (int i = 0; i < mu; ++i) {
+            weights.push_back(std::log(mu + 0.5) - std::log(i + 1.0));
+            sum += weights.back();
+        }
+        for (double& w : weights) {
+            w /= sum;
+            sumSq += w * w;
+        }
+        muEff = 1.0 / sumSq;
+        cSigma = (muEff + 2.0) / (n + muEff + 5.0);
+        dSigma = 1.0 + 2.0 * std::max(0.0, std::sqrt((muEff - 1.0) / (n + 1.0)) - 1.0) + cSigma;
+        cMu = std::min(1.0, (n + 2.0) / 3.0 * 2.0 * (muEff - 2.0 + 1.0 / muEff) / ((n + 2.0) * (n + 2.0) + muEff));
+        chiN = std::sqrt((double)n) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+    }
+
+    // lambda points; x is clipped into the unit cube by reflection
+    void Sample(std::vector<std::vector<double>>& x) {
+        std::normal_distribution<double> normal;
+        z.assign(lambda, std::vector<double>(n));
+        x.assign(lambda, std::vector<double>(n));
+        for (int k = 0; k < lambda; ++k) {
+            for (int i = 0; i < n; ++i) {
+                z[k][i] = normal(rng);
+                double v = mean[i] + sigma * std::sqrt(diag[i]) * z[k][i];
+                v = std::fmod(std::abs(v), 2.0);
+                x[k][i] = v > 1.0 ? 2.0 - v : v;
+            }
+        }
+    }
+
+    // order: the sampled points, best first
+    void Update(const std::vector<int>& order) {
+        std::vector<double> zMean(n, 0.0);
+        for (int r = 0; r < mu; ++r) {
+            for (int i = 0; i < n; ++i) {
+                zMean[i] += weights[r] * z[order[r]][i];
+            }
+        }
+        double norm = 0.0;
+        for (int i = 0; i < n; ++i) {
+            mean[i] = std::min(1.0, std::max(0.0, mean[i] + sigma * std::sqrt(diag[i]) * zMean[i]));
+            pathSigma[i] = (1.0 - cSigma) * pathSigma[i] + std::sqrt(cSigma * (2.0 - cSigma) * muEff) * zMean[i];
+            norm += pathSigma[i] * pathSigma[i];
+        }
+        for (int i = 0; i < n; ++i) {
+            double rankMu = 0.0;
+            for (int r = 0; r < mu; ++r) {
+                rankMu += weights[r] * diag[i] * z[order[r]][i] * z[order[r]][i];
+            }
+            diag[i] = (1.0 - cMu) * diag[i] + cMu * rankMu;
+        }
+        sigma *= std::exp(cSigma / dSigma * (std::sqrt(norm) / chiN - 1.0));
+        sigma = std::min(1.0, std::max(0.001, sigma));
+    }
+
+    double GetSigma() const { return sigma; }
+
+private:
+    int n, lambda, mu;
+    std::vector<double> weights;
+    double muEff, cSigma, dSigma, cMu, chiN;
+    std::vector<double> mean, diag, pathSigma;
+    double sigma;
+    std::vector<std::vector<double>> z;
+    std::mt19937 rng;
+};
+
+// Order of a generation, best first: Pareto front by front, larger gaps to the
+// neighbors first within a front; runs that were stopped or left calls unserved last
+static std::vector<int> RankGeneration(const std::vector<ElevatorTuneResult>& results, const ElevatorTuneResult& baseline) {
+    std::vector<int> order, rest;
+    for (int k = 0; k < (int)results.size(); ++k) {
+        (IsFeasible(results[k], baseline) ? order : rest).push_back(k);
+    }
+
+    std::vector<int> ranked;
+    while (!order.empty()) {
+        std::vector<int> front, dominated;
+        for (int a : order) {
+            bool isDominated = false;
+            for (int b : order) {
+                if (Dominates(results[b], results[a])) {
+                    isDominated = true;
+                    break;
+                }
+            }
+            (isDominated ? dominated : front).push_back(a);
+        }
+
+        //crowding distance over both objectives, ends of the front first
+        std::vector<double> crowding(results.size(), 0.0);
+        for (int objective = 0; objective < 2; ++objective) {
+            auto value = [&](int k) { return objective == 0 ? (double)results[k].p99Wait : results[k].energy; };
+            std::stable_sort(front.begin(), front.end(), [&](int a, int b) { return value(a) < value(b); });
+            double range = value(front.back()) - value(front.front());
+            crowding[front.front()] = crowding[front.back()] = HUGE_VAL;
+            for (size_t i = 1; i + 1 < front.size(); ++i) {
+                if (range > 0.0) crowding[front[i]] += (value(front[i + 1]) - value(front[i - 1])) / range;
+            }
+        }
+        std::stable_sort(front.begin(), front.end(), [&](int a, int b) { return crowding[a] > crowding[b]; });
+        ranked.insert(ranked.end(), front.begin(), front.end());
+        order.swap(dominated);
+    }
+    ranked.insert(ranked.end(), rest.begin(), rest.end());
+    return ranked;
+}
+
+ElevatorTuneReport RunTuner(const ElevatorTrace& trace, const ElevatorRunOptions& options, const ElevatorTuneOptions& tune, std::ostream& out) {
+    auto start = std::chrono::steady_clock::now();
+    ElevatorTuneReport report;
+    report.numWorkers = tune.numWorkers > 0 ? tune.numWorkers : std::max(1, (int)std::thread::hardware_concurrency());
+
+    std::map<uint64_t, ElevatorTuneResult> cache;
+    if (!tune.cacheFile.empty()) {
+        LoadCache(tune.cacheFile, cache);
+    }
+    uint64_t runHash = HashRun(trace, options, tune);
+    auto keyOf = [&](const ElevatorTuneSettings& s) { return HashValue(runHash, s.Hash()); };
+
+    //a batch of settings: cached ones are looked up, the others run on the workers
+    std::vector<ElevatorTuneResult> archive;   // complete runs of this search
+    auto evaluateBatch = [&](const std::vector<ElevatorTuneSettings>& batch, const std::vector<ElevatorTuneResult>& front) {
+        std::vector<uint64_t> keys;
+        std::vector<ElevatorTuneSettings> jobs;
+        std::map<uint64_t, ElevatorTuneResult> batchResults;
+        for (const auto& s : batch) {
+            uint64_t key = keyOf(s);
+            keys.push_back(key);
+            if (cache.count(key) || batchResults.count(key)) {
+                report.numCacheHits++;
+                continue;
+            }
+            batchResults[key] = ElevatorTuneResult();
+            jobs.push_back(s);
+        }
+
+        std::vector<ElevatorTuneResult> jobResults(jobs.size());
+        std::atomic<size_t> next(0);
+        auto worker = [&]() {
+            for (size_t j = next++; j < jobs.size(); j = next++) {
+                jobResults[j] = Evaluate(trace, options, tune, jobs[j], front);
+            }
+        };
+        std::vector<std::thread> threads;
+        for (int w = 1; w < std::min(report.numWorkers, (int)jobs.size()); ++w) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        for (const auto& r : jobResults) {
+            cache[keyOf(r.settings)] = r;
+            report.numRuns++;
+            if (!r.complete) report.numStoppedEarly++;
+        }
+        std::vector<ElevatorTuneResult> results;
+        for (uint64_t key : keys) {
+            results.push_back(cache[key]);
+        }
+        report.numCandidates += (int)batch.size();
+        return results;
+    };
+
+    ElevatorTuneSettings baseline;
+    baseline.strategy = options.strategy;
+    baseline.parking = options.parking;
+    baseline.params = options.parkingParams;
+    baseline.Normalize();
+    report.baseline = evaluateBatch({ baseline }, {}).front();
+    if (!report.baseline.complete) {
+        //stopped as a candidate of an earlier search, the baseline needs the whole run
+        report.baseline = Evaluate(trace, options, tune, baseline, {});
+        cache[keyOf(baseline)] = report.baseline;
+        report.numRuns++;
+    }
+    archive.push_back(report.baseline);
+
+    std::vector<std::string> strategies = ElevatorStrategyRegistry::Instance().GetNames();
+    int lambda = tune.populationSize > 0 ? tune.populationSize : 4 + (int)(3.0 * std::log((double)NUM_DIMENSIONS));
+    lambda = std::max(2, lambda);
+    ElevatorSepCMA cma(NUM_DIMENSIONS, lambda, tune.seed);
+
+    for (int g = 0; g < tune.generations; ++g) {
+        int runsBefore = report.numRuns, hitsBefore = report.numCacheHits, stoppedBefore = report.numStoppedEarly;
+        std::vector<std::vector<double>> x;
+        cma.Sample(x);
+        std::vector<ElevatorTuneSettings> batch;
+        for (const auto& point : x) {
+            batch.push_back(Decode(point.data(), strategies, trace.numFloors));
+        }
+
+        std::vector<ElevatorTuneResult> results = evaluateBatch(batch, ParetoFront(archive));
+        for (const auto& r : results) {
+            if (IsFeasible(r, report.baseline)) archive.push_back(r);
+        }
+        cma.Update(RankGeneration(results, report.baseline));
+
+        std::vector<ElevatorTuneResult> front = ParetoFront(archive);
+        out << "Generation " << (g + 1) << "/" << tune.generations << ": " << (report.numRuns - runsBefore) << " run, "
+            << (report.numCacheHits - hitsBefore) << " cached, " << (report.numStoppedEarly - stoppedBefore) << " stopped early; front "
+            << front.size() << " point(s)";
+        if (!front.empty()) {
+            out << ", p99 " << front.front().p99Wait << "-" << front.back().p99Wait << std::fixed << std::setprecision(2)
+                << ", energy " << front.back().energy << "-" << front.front().energy;
+        }
+        out << ", step size " << std::setprecision(3) << cma.GetSigma() << std::endl;
+    }
+
+    report.front = ParetoFront(archive);
+    if (!tune.cacheFile.empty() && !SaveCache(tune.cacheFile, cache)) {
+        out << "Couldn't write the evaluation cache: " << tune.cacheFile << std::endl;
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+void PrintTuneReport(std::ostream& out, const ElevatorTuneReport& report) {
+    out << "\n" << report.numCandidates << " candidates: " << report.numRuns << " run (" << report.numStoppedEarly
+        << " stopped early), " << report.numCacheHits << " from the cache; " << report.numWorkers << " worker thread(s), "
+        << std::fixed << std::setprecision(2) << report.seconds << " s\n";
+
+    auto printRow = [&](const ElevatorTuneResult& r) {
+        out << std::right << std::setw(10) << r.p99Wait << std::setw(10) << std::setprecision(2) << r.avgWait
+            << std::setw(12) << r.energy << "  " << r.settings.Describe() << "\n";
+    };
+    out << std::right << std::setw(10) << "p99 wait" << std::setw(10) << "Avg wait" << std::setw(12) << "Energy" << "  Settings\n";
+    out << "Baseline:\n";
+    printRow(report.baseline);
+    out << "Pareto front (p99 wait vs energy):\n";
+    for (const auto& r : report.front) {
+        printRow(r);
+    }
+    out.flush();
+}
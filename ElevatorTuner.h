@@ -0,0 +1,86 @@
+#pragma once
+#ifndef ElevatorTuner_h
+#define ElevatorTuner_h
+
+#include "ElevatorParking.h"
+#include "ElevatorReport.h"
+#include "ElevatorTraceReader.h"
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+//*****************************************************************************
+// Automatic search over the dispatch settings of a trace, for the trade-off
+// between p99 wait and energy. The settings are the dispatch policy, the
+// parking policy and its ElevatorParkingParams (lobby floor, half-life of the
+// call rates, idle delay before parking).
+//
+// The search is an evolution strategy with a diagonal covariance (sep-CMA-ES)
+// over the settings mapped into the unit cube; policies are picked by which
+// slice of their axis a sample falls in. Candidates are ranked by Pareto front
+// (then by how far they are from their neighbors on it), and every generation
+// is one batch of headless runs spread over worker threads.
+//
+// - early stopping: every run is checked after the first part of the trace; if
+//   the best settings found so far were already clearly better on both counts at
+//   that point, the run is dropped
+// - cache: results are kept by a hash of the settings (and of the trace and the
+//   energy model), so no setting is run twice; optionally kept in a file across runs
+// The results don't depend on the number of worker threads
+
+struct ElevatorTuneOptions
+{
+    int generations = 15;
+    int populationSize = 0;          // candidates per generation, 0: 4 + 3 ln(dimensions)
+    int numWorkers = 0;              // 0: one per core
+    uint32_t seed = 1;
+    double checkFraction = 0.25;     // early stopping checkpoint, as a part of the trace
+    double stopMargin = 0.10;        // how much better the front has to be to stop a run
+    std::string cacheFile;           // optional, read before and written after the search
+};
+
+struct ElevatorTuneSettings
+{
+    std::string strategy = "default";
+    std::string parking = "none";
+    ElevatorParkingParams params;
+
+    // Parameters the parking policy doesn't use are reset, so equal runs hash the same
+    void Normalize();
+    uint64_t Hash() const;
+    std::string Describe() const;   // as command line options
+};
+
+struct ElevatorTuneResult
+{
+    ElevatorTuneSettings settings;
+    bool complete = false;       // false: stopped at the checkpoint
+    int numServiced = 0;
+    int numRequests = 0;
+    int p99Wait = 0;
+    double avgWait = 0.0;
+    double energy = 0.0;         // net energy
+    int checkP99Wait = 0;        // at the checkpoint
+    double checkEnergy = 0.0;
+};
+
+struct ElevatorTuneReport
+{
+    ElevatorTuneResult baseline;             // the settings the search started from
+    std::vector<ElevatorTuneResult> front;   // p99 wait vs energy, lowest p99 first
+    int numCandidates = 0;
+    int numRuns = 0;
+    int numCacheHits = 0;
+    int numStoppedEarly = 0;
+    int numWorkers = 0;
+    double seconds = 0.0;
+};
+
+// Runs the search; one progress line per generation goes to out
+ElevatorTuneReport RunTuner(const ElevatorTrace& trace, const ElevatorRunOptions& options, const ElevatorTuneOptions& tune, std::ostream& out);
+
+void PrintTuneReport(std::ostream& out, const ElevatorTuneReport& report);
+
+#endif
@@ -1,61 +1,495 @@
 #include "ECGraphicViewImp.h"
 #include "ElevatorObserver.h"
+#include "ElevatorReplayObserver.h"
+#include "ElevatorAnalyticsObserver.h"
 #include "ECElevatorSim.h"
+#include "ElevatorReport.h"
+#include "ElevatorRealtime.h"
+#include "ElevatorCampus.h"
+#include "ElevatorBank.h"
+#include "ElevatorRender.h"
+#include "ElevatorTuner.h"
+#include "ElevatorAgents.h"
+#include "ElevatorGolden.h"
+#include "ElevatorFuzz.h"
+#include "ElevatorStrategyRegistry.h"
+#include "ElevatorParking.h"
+#include "ElevatorTraceReader.h"
+#include "ECProfiler.h"
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <cstdlib>
+#include <cctype>
+#include <utility>
 
+static void PrintUsage(const char* prog)
+{
+    std::cout << "Arguments required: " << prog << " <input-file> [--strategy <name>] [--compare] [--headless] [--parking none|lobby|predictive|compare] [--lobby-floor <floor>] [--half-life <steps>] [--idle-delay <steps>] [--regen [efficiency]] [--event-log <file>] [--profile [<trace-file>]]" << std::endl;
+    std::cout << "       " << prog << " <input-file> --realtime <socket-path> [--tick-ms <ms>] [--strategy <name>] [--event-log <file>]" << std::endl;
+    std::cout << "       " << prog << " <input-file> --tune [--generations <n>] [--population <n>] [--workers <n>] [--seed <n>] [--tune-cache <file>]" << std::endl;
+    std::cout << "       " << prog << " <input-file> --agents [--patience <steps>] [--stairs <floors>] [--repress <steps>] [--no-groups] [--strategy <name>] [--event-log <file>]" << std::endl;
+    std::cout << "       " << prog << " <input-file> --render <video.y4m|frame-pattern.png> [--render-speed 1|10|100] [--render-workers <n>] [--strategy <name>] [--parking <policy>]" << std::endl;
+    std::cout << "       " << prog << " <input-file> --bank <cars> [--dispatch collective|destination|compare] [--budget-us <us>] [--strategy <name>]" << std::endl;
+    std::cout << "       " << prog << " --campus <campus-file> [--workers <n>] [--epoch <steps>] [--strategy <name>]" << std::endl;
+    std::cout << "       " << prog << " --golden <golden-file> [--update-golden] [--tolerance <percent>]" << std::endl;
+    std::cout << "       " << prog << " --fuzz [<cases>] [--seed <n>] [--fuzz-out <file>]" << std::endl;
+    std::cout << "       " << prog << " --fuzz-check <reproducer>" << std::endl;
+    std::cout << "       " << prog << " --decode <event-log>" << std::endl;
+    std::cout << "       " << prog << " --replay <event-log> [--start <time>]" << std::endl;
+    std::cout << "       " << prog << " --analyze <event-log> [--heatmap <image>]" << std::endl;
+    std::cout << "       " << prog << " --list-strategies" << std::endl;
+}
+
+//true for arguments meant as a number, like "0.35" or "1" (file names aren't)
+static bool IsNumberArg(const std::string& arg)
+{
+    return !arg.empty() && (isdigit((unsigned char)arg[0]) || arg[0] == '.') && arg.find_first_not_of("0123456789.eE+-") == std::string::npos;
+}
+
+//the whole argument as a number in [0, 1]; false if it isn't one
+static bool ParseFraction(const char* arg, double& value)
+{
+    char* end = NULL;
+    value = std::strtod(arg, &end);
+    return end != arg && *end == '\0' && value >= 0.0 && value <= 1.0;
+}
+
+static void PrintStrategies()
+{
+    ElevatorStrategyRegistry& registry = ElevatorStrategyRegistry::Instance();
+    for (const auto& name : registry.GetNames()) {
+        std::cout << "  " << name << ": " << registry.GetDescription(name) << std::endl;
+    }
+}
+
+//per-phase timing table and optional Chrome trace (only with EC_ENABLE_PROFILING)
+static void PrintProfile(bool profile, const std::string& traceFile)
+{
+    if (!profile || !ECProfiler::IsCompiledIn()) return;
+
+    ECProfiler::PrintReport(std::cout);
+    if (!traceFile.empty() && !ECProfiler::WriteChromeTrace(traceFile)) {
+        std::cout << "Couldn't write trace: " << traceFile << std::endl;
+    }
+}
+
+//opens the replay viewer on a recorded event log
+static int RunReplay(const std::string& logFile, int startTime)
+{
+    ElevatorReplay replay;
+    if (!replay.Open(logFile)) {
+        std::cout << "Couldn't read event log: " << logFile << std::endl;
+        return 1;
+    }
+    replay.SeekTo(startTime);
+
+    const int widthWin = 500, heightWin = 800;
+    ECGraphicViewImp view(widthWin, heightWin);
+
+    ElevatorReplayObserver obs(view, replay);
+    view.Attach(&obs);
+
+    view.Show();
+    return 0;
+}
+
+// Congestion over floors and time, from a recorded event log: a text summary,
+// and the panels saved as an image (or shown in a window if there is no image file)
+static int RunAnalytics(const std::string& logFile, const std::string& imageFile)
+{
+    ElevatorAnalytics analytics;
+    std::string error;
+    if (!AnalyzeEventLog(logFile, ElevatorAnalyticsOptions(), analytics, error)) {
+        std::cout << "Couldn't read event log: " << error << std::endl;
+        return 1;
+    }
+    PrintAnalyticsReport(std::cout, analytics);
+
+    if (!imageFile.empty()) {
+        if (!RenderAnalytics(analytics, imageFile)) {
+            std::cout << "Couldn't save image: " << imageFile << std::endl;
+            return 1;
+        }
+        return 0;
+    }
 
+    int widthWin, heightWin;
+    ElevatorAnalyticsObserver::GetViewSize(analytics, widthWin, heightWin);
+    ECGraphicViewImp view(widthWin, heightWin);
+
+    ElevatorAnalyticsObserver obs(view, analytics);
+    view.Attach(&obs);
+
+    view.Show();
+    return 0;
+}
 
 int main(int argcount, char* argv[])
 {
+    std::string inputFile, eventLogFile, replayFile, profileFile, analyzeFile, heatmapFile;
+    bool profile = false;
+    int replayStart = 0;
+    bool compareMode = false, headless = false;
+    ElevatorRunOptions options;
+    ElevatorRealtimeOptions realtime;
+    std::string campusFile;
+    ElevatorCampusOptions campus;
+    bool bankMode = false;
+    ElevatorBankOptions bank;
+    ElevatorRenderOptions render;
+    bool tuneMode = false;
+    ElevatorTuneOptions tune;
+    bool agentMode = false;
+    ElevatorAgentOptions agents;
+    std::string goldenFile;
+    ElevatorGoldenOptions golden;
+    bool fuzz = false;
+    ElevatorFuzzOptions fuzzOptions;
+
+    //parse arguments
+    for (int i = 1; i < argcount; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--list-strategies") {
+            PrintStrategies();
+            return 0;
+        }
+        else if (arg == "--compare") {
+            compareMode = true;
+        }
+        else if (arg == "--headless") {
+            headless = true;
+        }
+        else if (arg == "--regen") {
+            //optional efficiency value
+            if (i + 1 < argcount && IsNumberArg(argv[i + 1])) {
+                double efficiency;
+                if (!ParseFraction(argv[++i], efficiency)) {
+                    std::cout << "Invalid regenerative efficiency: " << argv[i] << " (expected 0 to 1)" << std::endl;
+                    return 1;
+                }
+                options.energy = ElevatorEnergyModel::Regenerative(efficiency);
+            }
+            else {
+                options.energy = ElevatorEnergyModel::Regenerative();
+            }
+        }
+        else if (arg == "--strategy" && i + 1 < argcount) {
+            options.strategy = argv[++i];
+            bank.strategy = options.strategy;
+        }
+        else if (arg == "--profile") {
+            //optional Chrome trace output file
+            profile = true;
+            if (i + 1 < argcount && argv[i + 1][0] != '-') {
+                profileFile = argv[++i];
+            }
+        }
+        else if (arg == "--realtime" && i + 1 < argcount) {
+            realtime.socketPath = argv[++i];
+        }
+        else if (arg == "--tick-ms" && i + 1 < argcount) {
+            realtime.tickMs = std::atoi(argv[++i]);
+        }
+        else if (arg == "--parking" && i + 1 < argcount) {
+            options.parking = argv[++i];
+        }
+        else if (arg == "--render" && i + 1 < argcount) {
+            render.output = argv[++i];
+        }
+        else if (arg == "--render-speed" && i + 1 < argcount) {
+            render.speed = std::atoi(argv[++i]);
+        }
+        else if (arg == "--render-workers" && i + 1 < argcount) {
+            render.numWorkers = std::atoi(argv[++i]);
+        }
+        else if (arg == "--lobby-floor" && i + 1 < argcount) {
+            options.parkingParams.lobbyFloor = std::atoi(argv[++i]);
+        }
+        else if (arg == "--half-life" && i + 1 < argcount) {
+            options.parkingParams.halfLife = std::atof(argv[++i]);
+        }
+        else if (arg == "--idle-delay" && i + 1 < argcount) {
+            options.parkingParams.idleDelay = std::atoi(argv[++i]);
+        }
+        else if (arg == "--tune") {
+            tuneMode = true;
+        }
+        else if (arg == "--generations" && i + 1 < argcount) {
+            tune.generations = std::atoi(argv[++i]);
+        }
+        else if (arg == "--population" && i + 1 < argcount) {
+            tune.populationSize = std::atoi(argv[++i]);
+        }
+        else if (arg == "--tune-cache" && i + 1 < argcount) {
+            tune.cacheFile = argv[++i];
+        }
+        else if (arg == "--agents") {
+            agentMode = true;
+        }
+        else if (arg == "--patience" && i + 1 < argcount) {
+            agents.patience = std::atoi(argv[++i]);
+        }
+        else if (arg == "--stairs" && i + 1 < argcount) {
+            agents.stairsMaxFloors = std::atoi(argv[++i]);
+        }
+        else if (arg == "--repress" && i + 1 < argcount) {
+            agents.repressInterval = std::atoi(argv[++i]);
+        }
+        else if (arg == "--no-groups") {
+            agents.groupTravel = false;
+        }
+        else if (arg == "--bank" && i + 1 < argcount) {
+            bankMode = true;
+            bank.numCars = std::atoi(argv[++i]);
+        }
+        else if (arg == "--dispatch" && i + 1 < argcount) {
+            bank.dispatch = argv[++i];
+        }
+        else if (arg == "--budget-us" && i + 1 < argcount) {
+            bank.budgetUs = std::atof(argv[++i]);
+        }
+        else if (arg == "--campus" && i + 1 < argcount) {
+            campusFile = argv[++i];
+        }
+        else if (arg == "--workers" && i + 1 < argcount) {
+            campus.numWorkers = std::atoi(argv[++i]);
+        }
+        else if (arg == "--epoch" && i + 1 < argcount) {
+            campus.epochLength = std::atoi(argv[++i]);
+        }
+        else if (arg == "--golden" && i + 1 < argcount) {
+            goldenFile = argv[++i];
+        }
+        else if (arg == "--update-golden") {
+            golden.update = true;
+        }
+        else if (arg == "--tolerance" && i + 1 < argcount) {
+            golden.tolerance = std::atof(argv[++i]) / 100.0;
+        }
+        else if (arg == "--fuzz") {
+            //optional number of cases
+            fuzz = true;
+            if (i + 1 < argcount && argv[i + 1][0] != '-') {
+                fuzzOptions.iterations = std::atoi(argv[++i]);
+            }
+        }
+        else if (arg == "--seed" && i + 1 < argcount) {
+            fuzzOptions.seed = (uint32_t)std::strtoul(argv[++i], NULL, 10);
+        }
+        else if (arg == "--fuzz-out" && i + 1 < argcount) {
+            fuzzOptions.reproFile = argv[++i];
+        }
+        else if (arg == "--fuzz-check" && i + 1 < argcount) {
+            return CheckFuzzCase(argv[i + 1], std::cout);
+        }
+        else if (arg == "--event-log" && i + 1 < argcount) {
+            eventLogFile = argv[++i];
+        }
+        else if (arg == "--replay" && i + 1 < argcount) {
+            replayFile = argv[++i];
+        }
+        else if (arg == "--analyze" && i + 1 < argcount) {
+            analyzeFile = argv[++i];
+        }
+        else if (arg == "--heatmap" && i + 1 < argcount) {
+            heatmapFile = argv[++i];
+        }
+        else if (arg == "--start" && i + 1 < argcount) {
+            replayStart = std::atoi(argv[++i]);
+        }
+        else if (arg == "--decode" && i + 1 < argcount) {
+            //print a recorded event log as text
+            if (!DecodeEventLog(argv[i + 1], stdout)) {
+                std::cout << "Couldn't read event log: " << argv[i + 1] << std::endl;
+                return 1;
+            }
+            return 0;
+        }
+        else if (inputFile.empty() && arg[0] != '-') {
+            inputFile = arg;
+        }
+        else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    //play back a recorded run
+    if (!replayFile.empty()) {
+        return RunReplay(replayFile, replayStart);
+    }
+
+    //where and when a recorded run was congested
+    if (!analyzeFile.empty()) {
+        return RunAnalytics(analyzeFile, heatmapFile);
+    }
+
+    //optimized engine against the reference engine on random traces
+    if (fuzz) {
+        return RunFuzz(fuzzOptions, std::cout);
+    }
+
+    //regression check against recorded results and timings
+    if (!goldenFile.empty()) {
+        return RunGoldenCheck(goldenFile, golden, std::cout) == 0 ? 0 : 1;
+    }
+
+    //many buildings at once, no UI
+    if (!campusFile.empty()) {
+        if (!ElevatorStrategyRegistry::Instance().Contains(options.strategy)) {
+            std::cout << "Unknown strategy: " << options.strategy << std::endl;
+            return 1;
+        }
+        if (!IsParkingStrategy(options.parking)) {
+            std::cout << "Unknown parking policy: " << options.parking << std::endl;
+            return 1;
+        }
+        std::vector<ElevatorBuilding> buildings;
+        std::string error;
+        if (!LoadCampus(campusFile, buildings, error)) {
+            std::cout << "Couldn't load campus: " << error << std::endl;
+            return 1;
+        }
+        PrintCampusReport(std::cout, RunCampus(buildings, options, campus, std::cout));
+        return 0;
+    }
+
     //Error handling (gives user proper way to input file)
-    if (argcount != 2) {
-        std::cout << "Arguments required: " << argv[0] << " <input-file>" << std::endl;
+    if (inputFile.empty()) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    if (bankMode) {
+        options.strategy = bank.strategy;
+    }
+    if (!ElevatorStrategyRegistry::Instance().Contains(options.strategy)) {
+        std::cout << "Unknown strategy: " << options.strategy << ". Available strategies:" << std::endl;
+        PrintStrategies();
         return 1;
     }
 
-    std::vector<ECElevatorSimRequest> requestList;
-    int numOfLevels, lengthOfTime; //number of floors and the duration of the elevator's run
+    ElevatorTrace trace;
+    if (!LoadElevatorTrace(inputFile, trace)) {
+        std::cout << "Couldn't open file: " << inputFile << std::endl;
+        return 1;
+    }
+
+    //several cars, calls assigned by a group controller, no UI
+    if (bankMode) {
+        if (bank.numCars < 1) {
+            std::cout << "A bank needs at least one car" << std::endl;
+            return 1;
+        }
+        if (bank.dispatch == "compare") {
+            std::vector<ElevatorBankReport> reports;
+            for (const char* dispatch : { "collective", "destination" }) {
+                bank.dispatch = dispatch;
+                reports.push_back(RunBank(trace, bank, options.energy));
+            }
+            PrintBankComparison(std::cout, reports);
+            return 0;
+        }
+        if (bank.dispatch != "collective" && bank.dispatch != "destination") {
+            std::cout << "Unknown dispatch: " << bank.dispatch << std::endl;
+            return 1;
+        }
+        PrintBankReport(std::cout, RunBank(trace, bank, options.energy));
+        return 0;
+    }
 
-    std::ifstream fileStream(argv[1]);
-    if (!fileStream.is_open()) {
-        std::cout << "Couldn't open file: " << argv[1] << std::endl;
+    //every parking policy with the same dispatch policy, no UI
+    if (options.parking == "compare") {
+        PrintParkingComparison(std::cout, CompareParking(trace, options));
+        return 0;
+    }
+    if (!IsParkingStrategy(options.parking)) {
+        std::cout << "Unknown parking policy: " << options.parking << std::endl;
         return 1;
     }
 
-    //read first line for floors + time to simulate
-    std::string firstLine;
-    while (std::getline(fileStream, firstLine)) {
-        if (firstLine[0] == '#') continue;   //skip comments
-        std::stringstream iss(firstLine);
-        iss >> numOfLevels >> lengthOfTime;
-        break;
+    //search for the best settings, no UI
+    if (tuneMode) {
+        tune.numWorkers = campus.numWorkers;
+        tune.seed = fuzzOptions.seed;
+        PrintTuneReport(std::cout, RunTuner(trace, options, tune, std::cout));
+        return 0;
     }
 
-    //read passenger requests
-    while (std::getline(fileStream, firstLine))
-    {
-        if (firstLine[0] == '#') continue;   //skip comments
+    //run every strategy on the trace and rank them, no UI
+    if (compareMode) {
+        PrintComparison(std::cout, CompareStrategies(trace, ElevatorStrategyRegistry::Instance().GetNames(), options));
+        return 0;
+    }
 
-        int passengerAppearanceTime, originalFloor, destinationFloor;
-        std::stringstream iss(firstLine);
-        if (iss >> passengerAppearanceTime >> originalFloor >> destinationFloor) {
-            requestList.push_back(ECElevatorSimRequest(passengerAppearanceTime, originalFloor, destinationFloor));
+    //binary log of everything the simulator does
+    ElevatorEventLog eventLog;
+    if (!eventLogFile.empty()) {
+        if (!eventLog.Open(eventLogFile, trace.numFloors, trace.lenSim)) {
+            std::cout << "Couldn't create event log: " << eventLogFile << std::endl;
+            return 1;
         }
+        options.eventLog = &eventLog;
+    }
+
+    if (profile && !ECProfiler::IsCompiledIn()) {
+        std::cout << "Warning: built without EC_ENABLE_PROFILING, --profile has no effect" << std::endl;
     }
+    ECProfiler::SetTraceEnabled(profile && !profileFile.empty());
 
-    ECElevatorSim simulator(numOfLevels, requestList);
+    //live requests from a local socket, one step per tick, no UI
+    if (!realtime.socketPath.empty()) {
+        ElevatorRunReport report;
+        if (!RunRealtime(trace, options, realtime, report)) {
+            return 1;
+        }
+        PrintRunReport(std::cout, report);
+        PrintProfile(profile, profileFile);
+        return 0;
+    }
+
+    //every passenger decides for themselves (balk, stairs, groups), no UI
+    if (agentMode) {
+        if (!IsAgentModelAvailable()) {
+            std::cout << "Built without C++20 coroutines, --agents needs them" << std::endl;
+            return 1;
+        }
+        PrintAgentReport(std::cout, RunAgents(trace, options, agents));
+        PrintProfile(profile, profileFile);
+        return 0;
+    }
+
+    //the viewer's frames to a video or images, no window
+    if (!render.output.empty()) {
+        return RenderRun(trace, options, render, std::cout) ? 0 : 1;
+    }
+
+    //single run without UI, just the report
+    if (headless) {
+        PrintRunReport(std::cout, RunHeadless(trace, options));
+        PrintProfile(profile, profileFile);
+        return 0;
+    }
+
+    ECElevatorSim simulator(trace.numFloors, std::move(trace.requests), ElevatorStrategyRegistry::Instance().Create(options.strategy));
+    simulator.SetEventLog(options.eventLog);
+    simulator.SetParkingStrategy(CreateParkingStrategy(options.parking, trace.numFloors, options.parkingParams));
 
     //creates window to display UI
     const int widthWin = 500, heightWin = 800;
     ECGraphicViewImp view(widthWin, heightWin);
 
-    ElevatorObserver obs(view, simulator, lengthOfTime);
+    ElevatorObserver obs(view, simulator, trace.lenSim);
     view.Attach(&obs);
 
     view.Show();
 
+    //summary of what has been simulated when the window is closed
+    ElevatorRunReport report = BuildRunReport(simulator, options.energy);
+    report.strategy = options.strategy;
+    PrintRunReport(std::cout, report);
+    PrintProfile(profile, profileFile);
+
     return 0;
-}
\ No newline at end of file
+}